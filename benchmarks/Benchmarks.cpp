@@ -1,4 +1,15 @@
+#include "Autocorrelator.h"
+#include "ExcitationGenerator.h"
+#include "LPCProcessor.h"
+#include "LPCSynthesisFilter.h"
+#include "LevinsonDurbin.h"
+#include "PitchTracker.h"
+#include "PolyphaseResampler.h"
+#include "ProtectYourEars.h"
+#include "ReduxProcessor.h"
 #include "PluginEditor.h"
+#include "Throughput.h"
+#include "VisualizerFifo.h"
 #include "catch2/benchmark/catch_benchmark_all.hpp"
 #include "catch2/catch_test_macros.hpp"
 
@@ -38,3 +49,540 @@ TEST_CASE ("Boot performance")
         });
     };
 }
+
+TEST_CASE ("Autocorrelation")
+{
+    // Direct lag kernel vs. FFT over a grid of window sizes and lag counts.
+    // The crossover is where the FFT line starts winning; Autocorrelator::shouldUseDirect
+    // should flip at roughly the same place. Throughput is per channel, one frame per
+    // overlap-add hop (half a window) at the default LPC rate.
+    constexpr double lpcSampleRate = 8000.0;
+    juce::Random random (42);
+
+    for (const int windowSize : { 256, 512, 1024, 2048 })
+    {
+        std::vector<float> frame ((size_t) windowSize);
+        for (auto& sample : frame)
+            sample = random.nextFloat() * 2.0f - 1.0f;
+
+        Autocorrelator autocorrelator;
+        autocorrelator.prepare (windowSize);
+
+        // Lags 0..maxLag inclusive
+        std::vector<float> lags ((size_t) windowSize + 1);
+
+        for (const int maxLag : { 8, 16, 24, 64, 128, 256 })
+        {
+            const auto suffix = " (window " + std::to_string (windowSize) + ", lags " + std::to_string (maxLag) + ")";
+
+            BENCHMARK (throughput ("Direct" + suffix, windowSize / 2, lpcSampleRate))
+            {
+                Autocorrelator::computeDirect (frame.data(), windowSize, maxLag, lags.data());
+                return lags[0];
+            };
+
+            BENCHMARK (throughput ("FFT" + suffix, windowSize / 2, lpcSampleRate))
+            {
+                autocorrelator.computeFFT (frame.data(), windowSize, maxLag, lags.data());
+                return lags[0];
+            };
+        }
+    }
+}
+
+TEST_CASE ("LPC synthesis filter")
+{
+    // Per-sample cost of the two filter structures, mono at the default LPC rate
+    constexpr int blockSize = 512;
+    constexpr double lpcSampleRate = 8000.0;
+    juce::Random random (7);
+
+    std::vector<float> excitation ((size_t) blockSize);
+    for (auto& sample : excitation)
+        sample = random.nextFloat() * 2.0f - 1.0f;
+
+    std::vector<float> output ((size_t) blockSize);
+
+    for (int order = 4; order <= LPCSynthesisFilter::maxOrder; order += 4)
+    {
+        // A stable, moderately resonant model (|k| < 0.9)
+        std::vector<float> reflection ((size_t) order);
+        for (auto& k : reflection)
+            k = (random.nextFloat() * 2.0f - 1.0f) * 0.9f;
+
+        LPCSynthesisFilter directForm;
+        directForm.setReflectionCoefficients (reflection.data(), order);
+
+        LPCSynthesisFilter lattice;
+        lattice.setStructure (LPCSynthesisFilter::Structure::lattice);
+        lattice.setReflectionCoefficients (reflection.data(), order);
+
+        const auto suffix = " (order " + std::to_string (order) + ", " + std::to_string (blockSize) + " samples)";
+
+        BENCHMARK (throughput ("Direct form" + suffix, blockSize, lpcSampleRate))
+        {
+            directForm.process (excitation.data(), output.data(), blockSize, 0.1f);
+            return output.back();
+        };
+
+        BENCHMARK (throughput ("Lattice" + suffix, blockSize, lpcSampleRate))
+        {
+            lattice.process (excitation.data(), output.data(), blockSize, 0.1f);
+            return output.back();
+        };
+    }
+}
+
+TEST_CASE ("Levinson-Durbin")
+{
+    // Autocorrelation of a noisy two-partial frame, so every order gives a well-posed system.
+    // One solve per overlap-add hop, per channel, at the default LPC rate.
+    constexpr int windowSize = 1024;
+    constexpr double lpcSampleRate = 8000.0;
+    juce::Random random (11);
+
+    std::vector<float> frame ((size_t) windowSize);
+    for (int n = 0; n < windowSize; ++n)
+        frame[(size_t) n] = 0.3f * std::sin (0.05f * (float) n) + 0.1f * std::sin (0.31f * (float) n)
+                            + 0.05f * (random.nextFloat() * 2.0f - 1.0f);
+
+    std::vector<float> autocorrelation ((size_t) LevinsonDurbin::maxOrder + 1);
+    Autocorrelator::computeDirect (frame.data(), windowSize, LevinsonDurbin::maxOrder, autocorrelation.data());
+
+    std::array<float, LevinsonDurbin::maxOrder> lpc {};
+    std::array<float, LevinsonDurbin::maxOrder> reflection {};
+
+    for (int order = 4; order <= LevinsonDurbin::maxOrder; order += 4)
+    {
+        const auto suffix = " (order " + std::to_string (order) + ")";
+
+        BENCHMARK (throughput ("Float accumulation" + suffix, windowSize / 2, lpcSampleRate))
+        {
+            return LevinsonDurbin::solve (autocorrelation.data(), order, lpc.data(), reflection.data(), false);
+        };
+
+        BENCHMARK (throughput ("Double accumulation" + suffix, windowSize / 2, lpcSampleRate))
+        {
+            return LevinsonDurbin::solve (autocorrelation.data(), order, lpc.data(), reflection.data(), true);
+        };
+    }
+}
+
+TEST_CASE ("Polyphase resampler")
+{
+    // Throughput for one second of stereo audio in host-sized blocks, per quality tier
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+    juce::Random random (13);
+
+    struct Conversion
+    {
+        double inRate, outRate;
+        const char* name;
+    };
+
+    const Conversion conversions[] = { { 48000.0, 8000.0, "48k -> 8k" },
+        { 44100.0, 11025.0, "44.1k -> 11.025k" },
+        { 8000.0, 48000.0, "8k -> 48k" },
+        { 11025.0, 44100.0, "11.025k -> 44.1k" } };
+
+    const std::pair<PolyphaseResampler::Quality, const char*> qualities[] = { { PolyphaseResampler::Quality::low, "low" },
+        { PolyphaseResampler::Quality::medium, "medium" },
+        { PolyphaseResampler::Quality::high, "high" } };
+
+    std::vector<std::vector<float>> input ((size_t) numChannels, std::vector<float> ((size_t) blockSize));
+    for (auto& channel : input)
+        for (auto& sample : channel)
+            sample = random.nextFloat() * 2.0f - 1.0f;
+
+    const float* inputPointers[] = { input[0].data(), input[1].data() };
+
+    for (const auto& conversion : conversions)
+    {
+        for (const auto& [quality, qualityName] : qualities)
+        {
+            int up = 1, down = 1;
+            PolyphaseResampler::approximateRatio (conversion.inRate, conversion.outRate, 64, up, down);
+
+            PolyphaseResampler resampler;
+            resampler.prepare (numChannels, blockSize, up, down, quality);
+            resampler.setRatio (up, down);
+
+            std::vector<std::vector<float>> output ((size_t) numChannels, std::vector<float> ((size_t) resampler.getMaxOutputSamples (blockSize)));
+            float* outputPointers[] = { output[0].data(), output[1].data() };
+
+            const int blocksPerSecond = (int) conversion.inRate / blockSize;
+
+            BENCHMARK (throughput (std::string (conversion.name) + ", " + qualityName + " (1 s stereo)", blocksPerSecond * blockSize, conversion.inRate))
+            {
+                int produced = 0;
+                for (int block = 0; block < blocksPerSecond; ++block)
+                    produced += resampler.process (inputPointers, blockSize, outputPointers);
+
+                return produced;
+            };
+        }
+    }
+}
+
+TEST_CASE ("Pitch tracker")
+{
+    // Per-frame cost of PITCH_DETECTION: the longer autocorrelation it needs plus the
+    // NSDF peak search. One frame per hop per channel, so throughput is per channel,
+    // with a hop of half a window.
+    juce::Random random (17);
+
+    const std::pair<double, int> configurations[] = { { 8000.0, 512 }, { 16000.0, 512 }, { 48000.0, 1024 } };
+
+    for (const auto& [sampleRate, windowSize] : configurations)
+    {
+        std::vector<float> frame ((size_t) windowSize);
+        for (int n = 0; n < windowSize; ++n)
+        {
+            const float window = 0.5f * (1.0f - std::cos (2.0f * juce::MathConstants<float>::pi * (float) n / (float) windowSize));
+            const auto phase = 2.0f * juce::MathConstants<float>::pi * 140.0f * (float) n / (float) sampleRate;
+            frame[(size_t) n] = window * (std::sin (phase) + 0.5f * std::sin (2.0f * phase) + 0.05f * (random.nextFloat() * 2.0f - 1.0f));
+        }
+
+        Autocorrelator autocorrelator;
+        autocorrelator.prepare (windowSize);
+
+        PitchTracker tracker;
+        tracker.prepare (windowSize, sampleRate);
+        tracker.setSampleRate (sampleRate);
+
+        std::vector<float> lags ((size_t) windowSize + 1);
+        const auto suffix = " (" + std::to_string ((int) sampleRate) + " Hz, window " + std::to_string (windowSize) + ")";
+
+        BENCHMARK (throughput ("LPC lags only" + suffix, windowSize / 2, sampleRate))
+        {
+            autocorrelator.compute (frame.data(), windowSize, 24, lags.data());
+            return lags[1];
+        };
+
+        BENCHMARK (throughput ("LPC + pitch lags, NSDF tracking" + suffix, windowSize / 2, sampleRate))
+        {
+            // Periods too long for the window are tracked on the tracker's own frames instead
+            if (tracker.needsOwnFrames())
+            {
+                autocorrelator.compute (frame.data(), windowSize, 24, lags.data());
+                tracker.pushSamples (frame.data(), windowSize / 2);
+                return tracker.processHistory().frequency;
+            }
+
+            autocorrelator.compute (frame.data(), windowSize, tracker.getMaxLag(), lags.data());
+            return tracker.process (frame.data(), windowSize, lags.data()).frequency;
+        };
+    }
+}
+
+TEST_CASE ("Excitation generator")
+{
+    // One frame of excitation next to the synthesis filter pass it feeds,
+    // i.e. the two halves of LPCProcessor::decodeLPC per frame
+    constexpr int windowSize = 512;
+    constexpr int hopSize = windowSize / 2;
+    constexpr double sampleRate = 8000.0;
+
+    ExcitationGenerator generator;
+    generator.setSeed (1);
+
+    std::vector<float> excitation ((size_t) windowSize);
+    std::vector<float> output ((size_t) windowSize);
+
+    BENCHMARK (throughput ("Noise (unvoiced frame)", hopSize, sampleRate))
+    {
+        generator.generateFrame (excitation.data(), windowSize, hopSize, sampleRate, 0.0f, 0.0f);
+        return excitation.back();
+    };
+
+    BENCHMARK (throughput ("Pulses (voiced frame, 140 Hz)", hopSize, sampleRate))
+    {
+        generator.generateFrame (excitation.data(), windowSize, hopSize, sampleRate, 140.0f, 1.0f);
+        return excitation.back();
+    };
+
+    BENCHMARK (throughput ("Pulses + noise (half voiced, 140 Hz)", hopSize, sampleRate))
+    {
+        generator.generateFrame (excitation.data(), windowSize, hopSize, sampleRate, 140.0f, 0.6f);
+        return excitation.back();
+    };
+
+    std::vector<float> reflection (16, 0.5f);
+    LPCSynthesisFilter filter;
+    filter.setReflectionCoefficients (reflection.data(), (int) reflection.size());
+
+    BENCHMARK (throughput ("Synthesis filter, order 16 (reference)", hopSize, sampleRate))
+    {
+        filter.processFrame (excitation.data(), output.data(), windowSize, hopSize, 0.1f);
+        return output.back();
+    };
+}
+
+TEST_CASE ("LPC synthesis modes")
+{
+    // One second of stereo through the whole LPCProcessor: overlap-add at half a
+    // window against interpolated synthesis at longer hops (fewer analyses)
+    constexpr int windowSize = 512;
+    constexpr int blockSize = 512;
+    constexpr double sampleRate = 48000.0;
+
+    juce::Random random (7);
+    juce::AudioBuffer<float> input (2, (int) sampleRate);
+
+    for (int ch = 0; ch < input.getNumChannels(); ++ch)
+        for (int i = 0; i < input.getNumSamples(); ++i)
+            input.setSample (ch, i, 0.5f * std::sin (0.03f * (float) i) + 0.1f * (random.nextFloat() * 2.0f - 1.0f));
+
+    juce::AudioBuffer<float> block (2, blockSize);
+
+    auto runSecond = [&] (LPCProcessor& processor) {
+        for (int start = 0; start + blockSize <= input.getNumSamples(); start += blockSize)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                block.copyFrom (ch, 0, input, ch, start, blockSize);
+
+            processor.process (block, block);
+        }
+
+        return block.getSample (0, 0);
+    };
+
+    for (int hop : { 0, windowSize / 2, windowSize, 2 * windowSize })
+    {
+        LPCProcessor processor (16, windowSize);
+
+        if (hop > 0)
+            processor.setSynthesisMode (LPCProcessor::SynthesisMode::interpolated, hop);
+
+        processor.prepare (sampleRate, blockSize, 2);
+
+        const auto name = hop == 0 ? "Overlap-add, hop " + std::to_string (windowSize / 2)
+                                   : "Interpolated, hop " + std::to_string (hop);
+
+        BENCHMARK (throughput (name + " (1 s stereo)", input.getNumSamples(), sampleRate))
+        {
+            return runSecond (processor);
+        };
+    }
+}
+
+TEST_CASE ("Redux")
+{
+    // One 512-sample stereo block at 48 kHz, i.e. ~10.7 ms of audio per iteration
+    constexpr int blockSize = 512;
+    constexpr double sampleRate = 48000.0;
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+
+    for (int i = 0; i < blockSize; ++i)
+    {
+        buffer.setSample (0, i, 0.8f * std::sin (0.05f * (float) i));
+        buffer.setSample (1, i, 0.8f * std::cos (0.05f * (float) i));
+    }
+
+    struct Setting
+    {
+        const char* name;
+        float bits;
+        double rate;
+        bool dither, shaping, antiAlias;
+    };
+
+    for (const auto& setting : { Setting { "Quantize only, 8 bits", 8.0f, 0.0, false, false, true },
+                                 Setting { "Quantize + TPDF dither", 8.0f, 0.0, true, false, true },
+                                 Setting { "Quantize + dither + noise shaping", 8.0f, 0.0, true, true, true },
+                                 Setting { "Sample-and-hold 11.025 kHz, naive", 24.0f, 11025.0, false, false, false },
+                                 Setting { "Sample-and-hold 11.025 kHz, minBLEP", 24.0f, 11025.0, false, false, true },
+                                 Setting { "Everything", 10.5f, 11025.0, true, true, true } })
+    {
+        ReduxProcessor redux;
+        redux.prepare (sampleRate, 2);
+        redux.setBitDepth (setting.bits);
+        redux.setTargetSampleRate (setting.rate);
+        redux.setDitherEnabled (setting.dither);
+        redux.setNoiseShapingEnabled (setting.shaping);
+        redux.setAntiAliasingEnabled (setting.antiAlias);
+
+        BENCHMARK (throughput (std::string (setting.name) + " (512 stereo samples)", blockSize, sampleRate))
+        {
+            redux.process (buffer);
+            return buffer.getSample (0, 0);
+        };
+    }
+}
+
+TEST_CASE ("LPC processor throughput")
+{
+    // LPCProcessor::process over model orders, window sizes and host block sizes,
+    // stereo at the default LPC rate (the engine runs the core at LPC_SAMPLE_RATE).
+    // Each run streams the same 8192 frames, so the block size only changes the slicing.
+    constexpr double sampleRate = 8000.0;
+    constexpr int numSamples = 8192;
+
+    juce::Random random (19);
+    juce::AudioBuffer<float> input (2, numSamples);
+
+    for (int ch = 0; ch < input.getNumChannels(); ++ch)
+        for (int i = 0; i < numSamples; ++i)
+            input.setSample (ch, i, 0.5f * std::sin (0.11f * (float) i) + 0.1f * (random.nextFloat() * 2.0f - 1.0f));
+
+    for (const int order : { 8, 16, 24 })
+    {
+        for (const int windowSize : { 256, 512, 1024, 2048 })
+        {
+            for (const int blockSize : { 32, 256, 2048 })
+            {
+                LPCProcessor processor (order, windowSize);
+                processor.prepare (sampleRate, blockSize, 2);
+
+                juce::AudioBuffer<float> block (2, blockSize);
+
+                const auto name = "Order " + std::to_string (order) + ", window " + std::to_string (windowSize)
+                                  + ", block " + std::to_string (blockSize);
+
+                BENCHMARK (throughput (name, numSamples, sampleRate))
+                {
+                    for (int start = 0; start < numSamples; start += blockSize)
+                    {
+                        for (int ch = 0; ch < 2; ++ch)
+                            block.copyFrom (ch, 0, input, ch, start, blockSize);
+
+                        processor.process (block, block);
+                    }
+
+                    return block.getSample (0, 0);
+                };
+            }
+        }
+    }
+
+    // The same stream with the pitch tracker on (its longer autocorrelation dominates)
+    LPCProcessor processor (16, 512);
+    processor.setPitchDetectionEnabled (true);
+    processor.setTargetSampleRate (sampleRate);
+    processor.prepare (sampleRate, 256, 2);
+
+    juce::AudioBuffer<float> block (2, 256);
+
+    BENCHMARK (throughput ("Order 16, window 512, block 256, pitch detection", numSamples, sampleRate))
+    {
+        for (int start = 0; start < numSamples; start += 256)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                block.copyFrom (ch, 0, input, ch, start, 256);
+
+            processor.process (block, block);
+        }
+
+        return block.getSample (0, 0);
+    };
+}
+
+TEST_CASE ("Protect your ears")
+{
+    // The output guard runs on every channel of every block; in normal use nothing
+    // trips it, so this is the cost of the scan alone (one channel, 512 samples)
+    constexpr int blockSize = 512;
+    constexpr double sampleRate = 48000.0;
+
+    std::vector<float> block ((size_t) blockSize);
+    for (int i = 0; i < blockSize; ++i)
+        block[(size_t) i] = 0.8f * std::sin (0.05f * (float) i);
+
+    BENCHMARK (throughput ("In range (512 samples)", blockSize, sampleRate))
+    {
+        protectYourEars (block.data(), blockSize);
+        return block.back();
+    };
+}
+
+TEST_CASE ("Visualizer FIFO")
+{
+    // The audio thread's side (decimate to mid/side and push) with and without an
+    // editor attached, and the analysis thread's side (pull what was pushed)
+    constexpr int blockSize = 512;
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+
+    for (int i = 0; i < blockSize; ++i)
+    {
+        buffer.setSample (0, i, 0.8f * std::sin (0.05f * (float) i));
+        buffer.setSample (1, i, 0.8f * std::cos (0.05f * (float) i));
+    }
+
+    for (const double sampleRate : { 48000.0, 96000.0 })
+    {
+        VisualizerFifo fifo;
+        fifo.prepareForAudio (sampleRate);
+
+        std::vector<float> mid ((size_t) blockSize), side ((size_t) blockSize);
+        const auto suffix = " (" + std::to_string ((int) sampleRate) + " Hz, 512 stereo samples)";
+
+        BENCHMARK (throughput ("Push, no consumer" + suffix, blockSize, sampleRate))
+        {
+            fifo.pushAudio (buffer);
+            return fifo.getNumReady();
+        };
+
+        fifo.setConsumerActive (true);
+
+        BENCHMARK (throughput ("Push + pull" + suffix, blockSize, sampleRate))
+        {
+            fifo.pushAudio (buffer);
+            return fifo.pullMidSide (mid.data(), side.data(), fifo.getNumReady());
+        };
+
+        fifo.setConsumerActive (false);
+    }
+}
+
+TEST_CASE ("Plugin processBlock")
+{
+    // The whole plugin at its default settings (LPC at 8 kHz, redux off, 50% mix),
+    // stereo at 48 kHz: 8192 frames per run, sliced into host blocks
+    constexpr double sampleRate = 48000.0;
+    constexpr int numSamples = 8192;
+
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    juce::Random random (23);
+    juce::AudioBuffer<float> input (2, numSamples);
+
+    for (int ch = 0; ch < input.getNumChannels(); ++ch)
+        for (int i = 0; i < numSamples; ++i)
+            input.setSample (ch, i, 0.5f * std::sin (0.02f * (float) i) + 0.1f * (random.nextFloat() * 2.0f - 1.0f));
+
+    for (const int oversamplingIndex : { 0, 1, 2 })
+    {
+        for (const int blockSize : { 64, 512, 2048 })
+        {
+            PluginProcessor plugin;
+
+            // Parameters are picked up by prepareToPlay
+            auto* oversampling = plugin.apvts.getParameter ("OVERSAMPLING");
+            oversampling->setValueNotifyingHost (oversampling->convertTo0to1 ((float) oversamplingIndex));
+            plugin.prepareToPlay (sampleRate, blockSize);
+
+            juce::AudioBuffer<float> block (2, blockSize);
+            juce::MidiBuffer midi;
+
+            const auto name = "Oversampling " + std::to_string (1 << oversamplingIndex) + "x, block " + std::to_string (blockSize);
+
+            BENCHMARK (throughput (name, numSamples, sampleRate))
+            {
+                for (int start = 0; start < numSamples; start += blockSize)
+                {
+                    for (int ch = 0; ch < 2; ++ch)
+                        block.copyFrom (ch, 0, input, ch, start, blockSize);
+
+                    plugin.processBlock (block, midi);
+                }
+
+                return block.getSample (0, 0);
+            };
+
+            plugin.releaseResources();
+        }
+    }
+}
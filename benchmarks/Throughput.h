@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+    Audio throughput for the benchmarks.
+
+    Wrap a benchmark's name to say how much audio one run of it processes:
+
+        BENCHMARK (throughput ("Redux, 512 samples", 512, 48000.0)) { ... };
+
+    Besides Catch2's own report, the throughput listener then prints the run's
+    mean as nanoseconds per sample frame and as a realtime factor (seconds of
+    audio processed per second of CPU; above 1 keeps up, on one core). Every
+    benchmark, wrapped or not, is also written to a JSON file, keyed by name, so
+    two builds can be compared. The file is named by the BYTEMARK_BENCHMARK_JSON
+    environment variable, or is benchmark-results.json in the working directory.
+
+    Returns the name unchanged. samplesPerRun counts sample frames (one per
+    channel), i.e. the length of audio one run covers.
+*/
+std::string throughput (const std::string& benchmarkName, int64_t samplesPerRun, double sampleRate);
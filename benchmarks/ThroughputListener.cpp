@@ -0,0 +1,174 @@
+#include "Throughput.h"
+
+#include <juce_core/juce_core.h>
+
+#include "catch2/benchmark/catch_benchmark_all.hpp"
+#include "catch2/reporters/catch_reporter_event_listener.hpp"
+#include "catch2/reporters/catch_reporter_registrars.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+namespace
+{
+    struct AudioLength
+    {
+        int64_t samples = 0;
+        double sampleRate = 0.0;
+    };
+
+    /** Audio per run, by benchmark name (filled in by throughput() as the benchmarks are declared). */
+    std::map<std::string, AudioLength>& getAudioLengths()
+    {
+        static std::map<std::string, AudioLength> lengths;
+        return lengths;
+    }
+
+    struct Result
+    {
+        std::string testCase, name;
+        double meanNanoseconds = 0.0, lowNanoseconds = 0.0, highNanoseconds = 0.0, standardDeviationNanoseconds = 0.0;
+        int samples = 0, iterations = 0;
+        AudioLength audio;
+
+        double getNanosecondsPerSample() const { return meanNanoseconds / (double) audio.samples; }
+        double getRealtimeFactor() const { return (double) audio.samples / audio.sampleRate * 1.0e9 / meanNanoseconds; }
+        bool hasThroughput() const { return audio.samples > 0 && audio.sampleRate > 0.0 && meanNanoseconds > 0.0; }
+    };
+
+    template <typename Duration>
+    double toNanoseconds (Duration duration)
+    {
+        return std::chrono::duration_cast<std::chrono::duration<double, std::nano>> (duration).count();
+    }
+
+    juce::var toJson (const Result& result)
+    {
+        auto* object = new juce::DynamicObject();
+        object->setProperty ("test_case", juce::String (result.testCase));
+        object->setProperty ("name", juce::String (result.name));
+        object->setProperty ("mean_ns", result.meanNanoseconds);
+        object->setProperty ("mean_low_ns", result.lowNanoseconds);
+        object->setProperty ("mean_high_ns", result.highNanoseconds);
+        object->setProperty ("std_dev_ns", result.standardDeviationNanoseconds);
+        object->setProperty ("samples", result.samples);
+        object->setProperty ("iterations", result.iterations);
+
+        if (result.hasThroughput())
+        {
+            object->setProperty ("audio_samples_per_run", (juce::int64) result.audio.samples);
+            object->setProperty ("sample_rate", result.audio.sampleRate);
+            object->setProperty ("ns_per_sample", result.getNanosecondsPerSample());
+            object->setProperty ("realtime_factor", result.getRealtimeFactor());
+        }
+
+        return object;
+    }
+
+    juce::File getReportFile()
+    {
+        const auto path = juce::SystemStats::getEnvironmentVariable ("BYTEMARK_BENCHMARK_JSON", "benchmark-results.json");
+        return juce::File::getCurrentWorkingDirectory().getChildFile (path);
+    }
+
+    //==========================================================================
+    /** Collects every benchmark's statistics, prints the throughput of the ones
+        declared with throughput() and writes them all out as JSON at the end.
+    */
+    class ThroughputListener : public Catch::EventListenerBase
+    {
+    public:
+        using Catch::EventListenerBase::EventListenerBase;
+
+        void testCaseStarting (const Catch::TestCaseInfo& testInfo) override
+        {
+            currentTestCase = testInfo.name;
+        }
+
+        void benchmarkEnded (const Catch::BenchmarkStats<>& stats) override
+        {
+            Result result;
+            result.testCase = currentTestCase;
+            result.name = stats.info.name;
+            result.meanNanoseconds = toNanoseconds (stats.mean.point);
+            result.lowNanoseconds = toNanoseconds (stats.mean.lower_bound);
+            result.highNanoseconds = toNanoseconds (stats.mean.upper_bound);
+            result.standardDeviationNanoseconds = toNanoseconds (stats.standardDeviation.point);
+            result.samples = (int) stats.info.samples;
+            result.iterations = stats.info.iterations;
+
+            if (const auto it = getAudioLengths().find (stats.info.name); it != getAudioLengths().end())
+                result.audio = it->second;
+
+            results.push_back (std::move (result));
+        }
+
+        void testRunEnded (const Catch::TestRunStats&) override
+        {
+            if (results.empty())
+                return;
+
+            printSummary();
+            writeReport();
+        }
+
+    private:
+        void printSummary() const
+        {
+            std::printf ("\n%-80s %14s %14s\n", "Throughput", "ns/sample", "x realtime");
+
+            for (const auto& result : results)
+                if (result.hasThroughput())
+                    std::printf ("%-80s %14.3f %14.1f\n",
+                        (result.testCase + " / " + result.name).substr (0, 80).c_str(),
+                        result.getNanosecondsPerSample(),
+                        result.getRealtimeFactor());
+        }
+
+        void writeReport() const
+        {
+            // Keyed by "test case / benchmark", in run order, so reports diff line by line
+            auto* benchmarks = new juce::DynamicObject();
+
+            for (const auto& result : results)
+                benchmarks->setProperty (juce::String (result.testCase + " / " + result.name), toJson (result));
+
+            auto* build = new juce::DynamicObject();
+            build->setProperty ("juce", juce::SystemStats::getJUCEVersion());
+            build->setProperty ("cpu", juce::SystemStats::getCpuModel());
+            build->setProperty ("cpu_cores", juce::SystemStats::getNumPhysicalCpus());
+            build->setProperty ("os", juce::SystemStats::getOperatingSystemName());
+           #if JUCE_DEBUG
+            build->setProperty ("config", "Debug");
+           #else
+            build->setProperty ("config", "Release");
+           #endif
+            build->setProperty ("time", juce::Time::getCurrentTime().toISO8601 (true));
+
+            auto* report = new juce::DynamicObject();
+            report->setProperty ("build", build);
+            report->setProperty ("benchmarks", benchmarks);
+
+            const auto file = getReportFile();
+
+            if (file.replaceWithText (juce::JSON::toString (juce::var (report))))
+                std::printf ("\nBenchmark results written to %s\n", file.getFullPathName().toRawUTF8());
+            else
+                std::printf ("\nCouldn't write benchmark results to %s\n", file.getFullPathName().toRawUTF8());
+        }
+
+        std::string currentTestCase;
+        std::vector<Result> results;
+    };
+}
+
+CATCH_REGISTER_LISTENER (ThroughputListener)
+
+//==============================================================================
+std::string throughput (const std::string& benchmarkName, int64_t samplesPerRun, double sampleRate)
+{
+    getAudioLengths()[benchmarkName] = { samplesPerRun, sampleRate };
+    return benchmarkName;
+}
@@ -0,0 +1,225 @@
+#include "OfflineRenderer.h"
+#include "ParameterPreset.h"
+
+#include <atomic>
+#include <cstdio>
+
+/**
+    ByteMarkRender: runs audio files through ByteMark without a DAW.
+
+        ByteMarkRender [--preset=FILE] [--output=DIR] [--jobs=N] [--block=SAMPLES]
+                       [--suffix=TEXT] INPUT...
+
+    Inputs are WAV or AIFF files, or directories (searched recursively). Files are
+    shared out between N worker threads (default: one per CPU core), each with
+    its own processor. Prints each file's realtime factor as it finishes, and the
+    overall throughput at the end. Exits with 1 if any file failed.
+*/
+namespace
+{
+    constexpr const char* audioFilePatterns = "*.wav;*.aif;*.aiff";
+
+    void printUsage()
+    {
+        std::printf ("Usage: ByteMarkRender [options] INPUT...\n"
+                     "Renders WAV/AIFF files (or every one in a directory) through ByteMark.\n\n"
+                     "  --preset=FILE     parameter preset (JSON of IDs and values, or a saved state as XML)\n"
+                     "  --output=DIR      where to write the results (default: next to each input)\n"
+                     "  --suffix=TEXT     appended to output file names (default: _bytemark)\n"
+                     "  --jobs=N          files rendered in parallel (default: number of CPU cores)\n"
+                     "  --block=SAMPLES   samples per processBlock call (default: 8192)\n");
+    }
+
+    juce::Array<juce::File> collectInputs (const juce::ArgumentList& args)
+    {
+        juce::Array<juce::File> inputs;
+
+        for (const auto& argument : args.arguments)
+        {
+            const auto file = argument.resolveAsFile();
+
+            if (file.isDirectory())
+            {
+                auto found = file.findChildFiles (juce::File::findFiles, true, audioFilePatterns);
+                found.sort();
+                inputs.addArray (found);
+            }
+            else
+            {
+                inputs.add (file);
+            }
+        }
+
+        return inputs;
+    }
+
+    //==========================================================================
+    /** Renders files from the shared list until there are none left. */
+    class RenderWorker : public juce::Thread
+    {
+    public:
+        RenderWorker (int index,
+                      const OfflineRenderer::Settings& settings,
+                      const ParameterPreset& preset,
+                      const juce::Array<juce::File>& filesToRender,
+                      std::atomic<int>& nextFileIndex,
+                      juce::CriticalSection& outputLock)
+            : juce::Thread ("ByteMark Render " + juce::String (index)),
+              renderer (settings, preset),
+              files (filesToRender),
+              nextFile (nextFileIndex),
+              printLock (outputLock)
+        {
+        }
+
+        ~RenderWorker() override { stopThread (-1); }
+
+        void run() override
+        {
+            for (int index = nextFile++; index < files.size() && ! threadShouldExit(); index = nextFile++)
+            {
+                const auto& input = files.getReference (index);
+                const auto stats = renderer.render (input);
+
+                const juce::ScopedLock lock (printLock);
+
+                if (stats.succeeded())
+                {
+                    audioSeconds += stats.audioSeconds;
+                    std::printf ("[%d/%d] %s -> %s: %.1f s of audio in %.2f s (%.1fx realtime)\n",
+                                 index + 1, files.size(), input.getFileName().toRawUTF8(),
+                                 stats.output.getFileName().toRawUTF8(), stats.audioSeconds,
+                                 stats.renderSeconds, stats.getRealtimeFactor());
+                }
+                else
+                {
+                    ++numFailed;
+                    std::fprintf (stderr, "[%d/%d] %s: %s\n", index + 1, files.size(),
+                                  input.getFullPathName().toRawUTF8(), stats.error.toRawUTF8());
+                }
+
+                std::fflush (stdout);
+            }
+        }
+
+        double audioSeconds = 0.0;
+        int numFailed = 0;
+
+    private:
+        OfflineRenderer renderer;
+        const juce::Array<juce::File>& files;
+        std::atomic<int>& nextFile;
+        juce::CriticalSection& printLock;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderWorker)
+    };
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // The processor's parameters and timers expect a message manager (never run here)
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ArgumentList args (argc, argv);
+
+    if (args.size() == 0 || args.containsOption ("--help|-h"))
+    {
+        printUsage();
+        return args.size() == 0 ? 1 : 0;
+    }
+
+    OfflineRenderer::Settings settings;
+    int numJobs = juce::SystemStats::getNumCpus();
+    juce::File presetFile;
+
+    if (args.containsOption ("--preset"))
+        presetFile = args.removeValueForOption ("--preset");
+
+    if (args.containsOption ("--output"))
+        settings.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile (args.removeValueForOption ("--output"));
+
+    if (args.containsOption ("--suffix"))
+        settings.suffix = args.removeValueForOption ("--suffix");
+
+    if (args.containsOption ("--jobs"))
+        numJobs = args.removeValueForOption ("--jobs").getIntValue();
+
+    if (args.containsOption ("--block"))
+        settings.blockSize = args.removeValueForOption ("--block").getIntValue();
+
+    if (numJobs < 1 || settings.blockSize < 1)
+    {
+        std::fprintf (stderr, "--jobs and --block need positive values\n");
+        return 1;
+    }
+
+    for (const auto& argument : args.arguments)
+    {
+        if (argument.isOption())
+        {
+            std::fprintf (stderr, "Unknown option: %s\n", argument.text.toRawUTF8());
+            return 1;
+        }
+    }
+
+    const auto inputs = collectInputs (args);
+
+    if (inputs.isEmpty())
+    {
+        std::fprintf (stderr, "No audio files to render\n");
+        return 1;
+    }
+
+    // Parsed once against a throwaway instance, applied to every worker's processor
+    ParameterPreset preset;
+
+    if (presetFile != juce::File())
+    {
+        PluginProcessor reference;
+        const auto loaded = ParameterPreset::load (presetFile, reference.apvts, preset);
+
+        if (loaded.failed())
+        {
+            std::fprintf (stderr, "%s\n", loaded.getErrorMessage().toRawUTF8());
+            return 1;
+        }
+    }
+
+    // One processor per worker, created here on the message thread
+    numJobs = juce::jmin (numJobs, inputs.size());
+    std::atomic<int> nextFile { 0 };
+    juce::CriticalSection printLock;
+    juce::OwnedArray<RenderWorker> workers;
+
+    for (int i = 0; i < numJobs; ++i)
+        workers.add (new RenderWorker (i, settings, preset, inputs, nextFile, printLock));
+
+    std::printf ("Rendering %d file%s on %d thread%s\n", inputs.size(), inputs.size() == 1 ? "" : "s",
+                 numJobs, numJobs == 1 ? "" : "s");
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    for (auto* worker : workers)
+        worker->startThread();
+
+    for (auto* worker : workers)
+        worker->waitForThreadToExit (-1);
+
+    const double wallSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    double audioSeconds = 0.0;
+    int numFailed = 0;
+
+    for (auto* worker : workers)
+    {
+        audioSeconds += worker->audioSeconds;
+        numFailed += worker->numFailed;
+    }
+
+    std::printf ("\n%d of %d files rendered: %.1f s of audio in %.2f s (%.1fx realtime, %.1fx per thread)\n",
+                 inputs.size() - numFailed, inputs.size(), audioSeconds, wallSeconds,
+                 wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0,
+                 wallSeconds > 0.0 ? audioSeconds / wallSeconds / numJobs : 0.0);
+
+    return numFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,152 @@
+#include "OfflineRenderer.h"
+
+namespace
+{
+    /** The processor is stereo in and out; other layouts would need a channel map. */
+    constexpr int processorChannels = 2;
+
+    /** The input's bit depth if the output format can write it, else 24 bits. */
+    int chooseBitDepth (juce::AudioFormat& format, int inputBits)
+    {
+        return format.getPossibleBitDepths().contains (inputBits) ? inputBits : 24;
+    }
+}
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer (const Settings& newSettings, const ParameterPreset& preset)
+    : settings (newSettings)
+{
+    settings.blockSize = juce::jmax (1, settings.blockSize);
+    formatManager.registerBasicFormats();
+    preset.applyTo (processor.apvts);
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+    processor.releaseResources();
+}
+
+juce::File OfflineRenderer::getOutputFileFor (const juce::File& input) const
+{
+    const auto directory = settings.outputDirectory == juce::File() ? input.getParentDirectory() : settings.outputDirectory;
+    return directory.getChildFile (input.getFileNameWithoutExtension() + settings.suffix + input.getFileExtension());
+}
+
+std::unique_ptr<juce::AudioFormatReader> OfflineRenderer::createReader (const juce::File& input)
+{
+    if (auto* format = formatManager.findFormatForFileExtension (input.getFileExtension()))
+    {
+        // Mapped: the OS pages the file in as it's read, with no copies through a stream buffer
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped (format->createMemoryMappedReader (input));
+
+        if (mapped != nullptr && mapped->mapEntireFile())
+            return mapped;
+    }
+
+    return std::unique_ptr<juce::AudioFormatReader> (formatManager.createReaderFor (input));
+}
+
+OfflineRenderer::Stats OfflineRenderer::render (const juce::File& input)
+{
+    Stats stats;
+    stats.output = getOutputFileFor (input);
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    auto reader = createReader (input);
+
+    if (reader == nullptr)
+    {
+        stats.error = "Not a readable audio file";
+        return stats;
+    }
+
+    if (reader->numChannels < 1 || reader->numChannels > (unsigned int) processorChannels || reader->sampleRate <= 0.0)
+    {
+        stats.error = "Only mono and stereo files are supported (" + juce::String (reader->numChannels) + " channels)";
+        return stats;
+    }
+
+    // Same format as the input (WAV stays WAV, AIFF stays AIFF)
+    auto* format = formatManager.findFormatForFileExtension (stats.output.getFileExtension());
+
+    if (format == nullptr)
+    {
+        stats.error = "No writer for " + stats.output.getFileExtension();
+        return stats;
+    }
+
+    if (stats.output == input)
+    {
+        stats.error = "The output would overwrite the input";
+        return stats;
+    }
+
+    // (deleteFile() succeeds when there's nothing to delete)
+    if (! stats.output.deleteFile() || stats.output.getParentDirectory().createDirectory().failed())
+    {
+        stats.error = "Can't write to " + stats.output.getFullPathName();
+        return stats;
+    }
+
+    auto stream = stats.output.createOutputStream();
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+
+    if (stream != nullptr)
+        writer.reset (format->createWriterFor (stream.get(), reader->sampleRate, reader->numChannels,
+                                               chooseBitDepth (*format, (int) reader->bitsPerSample), reader->metadataValues, 0));
+
+    if (writer == nullptr)
+    {
+        stats.error = "Couldn't create " + stats.output.getFullPathName();
+        return stats;
+    }
+
+    stream.release(); // now owned by the writer
+
+    // Offline: the processor may use its offline oversampling factor
+    processor.releaseResources();
+    processor.setNonRealtime (true);
+    processor.setRateAndBufferSizeDetails (reader->sampleRate, settings.blockSize);
+    processor.prepareToPlay (reader->sampleRate, settings.blockSize);
+    buffer.setSize (processorChannels, settings.blockSize, false, false, true);
+
+    const auto length = reader->lengthInSamples;
+    const auto latency = (juce::int64) processor.getLatencySamples();
+    juce::int64 written = 0;
+
+    // Input and then latency samples of silence in, everything after the first latency samples out
+    for (juce::int64 position = 0; position < length + latency; position += settings.blockSize)
+    {
+        const int numSamples = (int) juce::jmin ((juce::int64) settings.blockSize, length + latency - position);
+        const int numToRead = (int) juce::jlimit ((juce::int64) 0, (juce::int64) numSamples, length - position);
+
+        buffer.setSize (processorChannels, numSamples, false, false, true);
+        buffer.clear();
+
+        // A mono reader fills both channels
+        if (numToRead > 0)
+            reader->read (&buffer, 0, numToRead, position, true, true);
+
+        processor.processBlock (buffer, midi);
+
+        const int skip = (int) juce::jlimit ((juce::int64) 0, (juce::int64) numSamples, latency - position);
+        const int numToWrite = (int) juce::jmin ((juce::int64) (numSamples - skip), length - written);
+
+        if (numToWrite > 0)
+        {
+            if (! writer->writeFromAudioSampleBuffer (buffer, skip, numToWrite))
+            {
+                stats.error = "Write failed: " + stats.output.getFullPathName();
+                return stats;
+            }
+
+            written += numToWrite;
+        }
+    }
+
+    writer.reset(); // flushes and closes the file
+
+    stats.audioSeconds = (double) length / reader->sampleRate;
+    stats.renderSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    return stats;
+}
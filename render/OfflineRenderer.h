@@ -0,0 +1,66 @@
+#pragma once
+
+#include "ParameterPreset.h"
+#include "PluginProcessor.h"
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+/**
+    Renders audio files through one PluginProcessor, without a host.
+
+    Each file is streamed from a memory-mapped reader (falling back to a plain
+    reader for formats that can't be mapped) through processBlock in large
+    chunks, with the processor in non-realtime mode so the offline oversampling
+    setting applies. The plugin's latency is compensated: the first
+    getLatencySamples() output samples are dropped and the input is padded with
+    as much silence at the end, so the output lines up with the input and has the
+    same length. Mono files are rendered as dual mono and written back as mono.
+
+    An OfflineRenderer owns its processor and renders one file at a time; run
+    several, one per thread, to render in parallel. Construct it on the message
+    thread.
+*/
+class OfflineRenderer
+{
+public:
+    struct Settings
+    {
+        int blockSize = 8192; ///< samples per processBlock call.
+        juce::File outputDirectory; ///< empty: next to each input.
+        juce::String suffix = "_bytemark"; ///< appended to the output file name.
+    };
+
+    /** What one file took. */
+    struct Stats
+    {
+        juce::String error; ///< empty on success.
+        juce::File output;
+        double audioSeconds = 0.0;
+        double renderSeconds = 0.0; ///< wall time, reading and writing included.
+
+        bool succeeded() const noexcept { return error.isEmpty(); }
+        double getRealtimeFactor() const noexcept { return renderSeconds > 0.0 ? audioSeconds / renderSeconds : 0.0; }
+    };
+
+    OfflineRenderer (const Settings& settings, const ParameterPreset& preset);
+    ~OfflineRenderer();
+
+    /** Renders one file (blocking), preparing the processor for its sample rate. */
+    Stats render (const juce::File& input);
+
+    /** Where render() writes the output for an input file. */
+    juce::File getOutputFileFor (const juce::File& input) const;
+
+private:
+    /** A memory-mapped reader for the whole file, or a streaming one if it can't be mapped. */
+    std::unique_ptr<juce::AudioFormatReader> createReader (const juce::File& input);
+
+    Settings settings;
+    juce::AudioFormatManager formatManager;
+    PluginProcessor processor;
+
+    juce::AudioBuffer<float> buffer;
+    juce::MidiBuffer midi;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
@@ -0,0 +1,101 @@
+#include "ParameterPreset.h"
+
+namespace
+{
+    /** A JSON value in the parameter's own units, as a normalised value. */
+    juce::Result toNormalised (const juce::RangedAudioParameter& parameter, const juce::var& value, float& normalised)
+    {
+        if (value.isBool())
+        {
+            normalised = (bool) value ? 1.0f : 0.0f;
+            return juce::Result::ok();
+        }
+
+        if (value.isInt() || value.isInt64() || value.isDouble())
+        {
+            normalised = parameter.convertTo0to1 ((float) (double) value);
+            return juce::Result::ok();
+        }
+
+        if (value.isString())
+        {
+            // Choice names ("4x"), or anything the parameter can parse itself
+            if (const auto* choice = dynamic_cast<const juce::AudioParameterChoice*> (&parameter))
+            {
+                const int index = choice->choices.indexOf (value.toString(), true);
+
+                if (index < 0)
+                    return juce::Result::fail ("\"" + value.toString() + "\" isn't one of " + choice->choices.joinIntoString (", "));
+
+                normalised = parameter.convertTo0to1 ((float) index);
+                return juce::Result::ok();
+            }
+
+            normalised = parameter.getValueForText (value.toString());
+            return juce::Result::ok();
+        }
+
+        return juce::Result::fail ("expected a number, a boolean or a string");
+    }
+}
+
+//==============================================================================
+juce::Result ParameterPreset::load (const juce::File& file, juce::AudioProcessorValueTreeState& reference, ParameterPreset& preset)
+{
+    if (! file.existsAsFile())
+        return juce::Result::fail ("Preset not found: " + file.getFullPathName());
+
+    preset.values.clear();
+    preset.state.reset();
+
+    if (file.hasFileExtension ("xml"))
+    {
+        auto xml = juce::XmlDocument::parse (file);
+
+        if (xml == nullptr || ! xml->hasTagName (reference.state.getType()))
+            return juce::Result::fail ("Not a saved " + reference.state.getType().toString() + " state: " + file.getFullPathName());
+
+        preset.state = std::move (xml);
+        return juce::Result::ok();
+    }
+
+    juce::var json;
+    const auto parsed = juce::JSON::parse (file.loadFileAsString(), json);
+
+    if (parsed.failed())
+        return juce::Result::fail ("Couldn't parse " + file.getFileName() + ": " + parsed.getErrorMessage());
+
+    const auto* object = json.getDynamicObject();
+
+    if (object == nullptr)
+        return juce::Result::fail (file.getFileName() + " should hold an object of parameter IDs and values");
+
+    for (const auto& property : object->getProperties())
+    {
+        const auto parameterID = property.name.toString();
+        const auto* parameter = reference.getParameter (parameterID);
+
+        if (parameter == nullptr)
+            return juce::Result::fail ("Unknown parameter in " + file.getFileName() + ": " + parameterID);
+
+        Value value { parameterID };
+        const auto converted = toNormalised (*parameter, property.value, value.normalised);
+
+        if (converted.failed())
+            return juce::Result::fail (parameterID + ": " + converted.getErrorMessage());
+
+        preset.values.add (value);
+    }
+
+    return juce::Result::ok();
+}
+
+void ParameterPreset::applyTo (juce::AudioProcessorValueTreeState& apvts) const
+{
+    if (state != nullptr)
+        apvts.replaceState (juce::ValueTree::fromXml (*state));
+
+    for (const auto& value : values)
+        if (auto* parameter = apvts.getParameter (value.parameterID))
+            parameter->setValueNotifyingHost (juce::jlimit (0.0f, 1.0f, value.normalised));
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+/**
+    Parameter presets for the offline renderer, read from a file.
+
+    Two formats are accepted:
+    - JSON: an object of parameter IDs and values in the parameter's own units,
+      e.g. { "LPC_ORDER": 16, "LPC_SAMPLE_RATE": 11025, "PITCH_DETECTION": true,
+      "OVERSAMPLING_OFFLINE": "4x" }. Booleans may be true/false or 0/1, and
+      choices may be given by index or by name. Parameters not listed keep their
+      defaults.
+    - XML: a saved AudioProcessorValueTreeState (the "Parameters" tree), which
+      replaces the whole state.
+
+    The preset is parsed once and can then be applied to any number of processors
+    (on the message thread, before they're prepared).
+*/
+class ParameterPreset
+{
+public:
+    ParameterPreset() = default;
+
+    /** Reads a preset file, checking every entry against a processor's parameters
+        (any instance of the same plugin will do).
+    */
+    static juce::Result load (const juce::File& file, juce::AudioProcessorValueTreeState& reference, ParameterPreset& preset);
+
+    /** Sets every parameter in the preset on a processor's state. */
+    void applyTo (juce::AudioProcessorValueTreeState& apvts) const;
+
+    bool isEmpty() const noexcept { return values.isEmpty() && state == nullptr; }
+
+private:
+    /** One JSON entry, already converted to a normalised 0..1 value. */
+    struct Value
+    {
+        juce::String parameterID;
+        float normalised = 0.0f;
+    };
+
+    juce::Array<Value> values;
+    std::unique_ptr<juce::XmlElement> state;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterPreset)
+};
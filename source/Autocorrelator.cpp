@@ -0,0 +1,83 @@
+#include "Autocorrelator.h"
+#include "SIMDKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+//==============================================================================
+void Autocorrelator::prepare (int maxLength)
+{
+    // Zero-padding to 2 * maxLength keeps every lag free of circular wrap-around
+    const int newSize = juce::nextPowerOfTwo (2 * juce::jmax (1, maxLength));
+
+    if (newSize == fftSize && fft != nullptr)
+        return;
+
+    fftSize = newSize;
+    fft = std::make_unique<juce::dsp::FFT> ((int) std::log2 ((double) fftSize));
+    fftBuffer.assign ((size_t) fftSize * 2, 0.0f);
+}
+
+void Autocorrelator::compute (const float* data, int length, int maxLag, float* dest) noexcept
+{
+    if (usesFFT (length, maxLag))
+        computeFFT (data, length, maxLag, dest);
+    else
+        computeDirect (data, length, maxLag, dest);
+}
+
+//==============================================================================
+void Autocorrelator::computeDirect (const float* data, int length, int maxLag, float* dest) noexcept
+{
+    for (int k = 0; k <= maxLag; ++k)
+        dest[k] = k < length ? SIMDKernels::dotProduct (data, data + k, length - k) : 0.0f;
+}
+
+void Autocorrelator::computeFFT (const float* data, int length, int maxLag, float* dest) noexcept
+{
+    jassert (fft != nullptr && 2 * length <= fftSize); // call prepare() with a big enough size
+
+    // 1) Copy 'length' samples into the real part of fftBuffer, zero the rest
+    std::copy_n (data, length, fftBuffer.begin());
+    std::fill (fftBuffer.begin() + length, fftBuffer.end(), 0.0f);
+
+    // 2) Forward FFT
+    fft->performRealOnlyForwardTransform (fftBuffer.data(), true);
+
+    // 3) Compute power spectrum => real part = magnitude^2, imag part = 0
+    for (int i = 0; i <= fftSize / 2; ++i)
+    {
+        const float re = fftBuffer[2 * (size_t) i];
+        const float im = fftBuffer[2 * (size_t) i + 1];
+
+        fftBuffer[2 * (size_t) i] = re * re + im * im;
+        fftBuffer[2 * (size_t) i + 1] = 0.0f;
+    }
+
+    // 4) Inverse FFT => time-domain autocorrelation in fftBuffer.
+    //    JUCE already scales the inverse by 1 / fftSize, so the lags come out unnormalised
+    //    and match computeDirect().
+    fft->performRealOnlyInverseTransform (fftBuffer.data());
+
+    for (int k = 0; k <= maxLag; ++k)
+        dest[k] = k < length ? fftBuffer[(size_t) k] : 0.0f;
+}
+
+//==============================================================================
+bool Autocorrelator::shouldUseDirect (int length, int maxLag) noexcept
+{
+    // Rough operation counts, in units of one vector multiply-add:
+    // - direct: (maxLag + 1) dot products of ~length samples
+    // - FFT:    two transforms of N = nextPowerOfTwo (2 * length) points plus a spectrum pass
+    // The FFT weight is a coarse calibration against juce::dsp::FFT's fallback engine;
+    // run the "Autocorrelation" benchmarks to see the real crossover on a given backend.
+    constexpr double fftCostPerPointLog = 0.5;
+
+    const auto lags = (double) (juce::jmin (maxLag, length - 1) + 1);
+    const double directCost = lags * (double) length / (double) SIMDKernels::floatLanes;
+
+    const auto n = (double) juce::nextPowerOfTwo (2 * juce::jmax (1, length));
+    const double fftCost = fftCostPerPointLog * 2.0 * n * std::log2 (n) + n;
+
+    return directCost <= fftCost;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <memory>
+#include <vector>
+
+/**
+    Computes the (unnormalised) autocorrelation r[k] = sum x[n] * x[n + k] of a
+    frame for lags 0..maxLag.
+
+    Two methods are available:
+    - direct: one vectorised dot product per lag, O(length * maxLag)
+    - FFT:    forward real FFT, power spectrum, inverse FFT, O(N log N) for every lag
+
+    LPC analysis only needs lags up to the model order (24 at most), where the
+    direct kernel is several times cheaper than two FFTs. By default compute()
+    picks the cheaper method for each call from a simple cost model.
+*/
+class Autocorrelator
+{
+public:
+    enum class Method
+    {
+        automatic,
+        direct,
+        fft
+    };
+
+    Autocorrelator() = default;
+
+    /** Builds the FFT for frames of up to maxLength samples (any lag up to maxLength - 1). */
+    void prepare (int maxLength);
+
+    /** Forces one method, or lets the cost model decide (the default). */
+    void setMethod (Method newMethod) noexcept { method = newMethod; }
+
+    /** Writes lags 0..maxLag of the autocorrelation of data[0..length) into dest. */
+    void compute (const float* data, int length, int maxLag, float* dest) noexcept;
+
+    /** Time-domain lag kernel. */
+    static void computeDirect (const float* data, int length, int maxLag, float* dest) noexcept;
+
+    /** Frequency-domain method (requires prepare() with length <= maxLength). */
+    void computeFFT (const float* data, int length, int maxLag, float* dest) noexcept;
+
+    /** True when compute() would take the FFT path for these dimensions. */
+    bool usesFFT (int length, int maxLag) const noexcept
+    {
+        return fft != nullptr
+               && (method == Method::fft || (method == Method::automatic && ! shouldUseDirect (length, maxLag)));
+    }
+
+    /** Cost model: true when the direct kernel is expected to beat the FFT method. */
+    static bool shouldUseDirect (int length, int maxLag) noexcept;
+
+    int getFFTSize() const noexcept { return fftSize; }
+
+private:
+    Method method = Method::automatic;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    int fftSize = 0;
+    std::vector<float> fftBuffer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Autocorrelator)
+};
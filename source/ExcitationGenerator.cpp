@@ -0,0 +1,129 @@
+#include "ExcitationGenerator.h"
+#include "SIMDKernels.h"
+
+#include <cmath>
+
+//==============================================================================
+ExcitationGenerator::ExcitationGenerator()
+{
+    // Blackman-windowed sinc at 0.9 x Nyquist, one row per fractional offset
+    // (plus one extra row so interpolating between rows never wraps)
+    constexpr double cutoff = 0.9;
+    constexpr double pi = juce::MathConstants<double>::pi;
+    constexpr int half = pulseTaps / 2;
+
+    for (int phase = 0; phase <= pulsePhases; ++phase)
+    {
+        const double fraction = (double) phase / pulsePhases;
+
+        for (int k = 0; k < pulseTaps; ++k)
+        {
+            // Tap k sits at integer offset k - half + 1 from the sample before the pulse
+            const double t = (double) (k - half + 1) - fraction;
+            const double sinc = std::abs (t) < 1.0e-9 ? cutoff : std::sin (pi * cutoff * t) / (pi * t);
+            const double x = (t + half) / (double) pulseTaps; // 0..1 across the kernel
+            const double window = juce::jlimit (0.0, 1.0, 0.42 - 0.5 * std::cos (2.0 * pi * x) + 0.08 * std::cos (4.0 * pi * x));
+
+            pulseTable[(size_t) (phase * pulseTaps + k)] = (float) (sinc * window);
+        }
+    }
+}
+
+void ExcitationGenerator::setSeed (uint32_t newSeed) noexcept
+{
+    // Scramble so that neighbouring seeds (channel 0, 1, ...) give unrelated streams
+    seed = SIMDKernels::hashNoise (0x5eedu, newSeed);
+    reset();
+}
+
+void ExcitationGenerator::reset() noexcept
+{
+    noiseIndex = 0;
+    pulsePhase = 0.0;
+    pulseIncrement = 0.0;
+    mix = 0.0f;
+}
+
+void ExcitationGenerator::setVoicingRange (float low, float high) noexcept
+{
+    voicingLow = low;
+    voicingHigh = juce::jmax (low + 1.0e-3f, high);
+}
+
+//==============================================================================
+void ExcitationGenerator::addPulse (float* dest, int numSamples, double position, float amplitude) const noexcept
+{
+    constexpr int half = pulseTaps / 2;
+
+    const auto base = (int) std::floor (position);
+    const double fraction = (position - base) * pulsePhases;
+    const auto row = (int) fraction;
+    const auto blend = (float) (fraction - row);
+
+    const float* lower = pulseTable.data() + (size_t) row * pulseTaps;
+    const float* upper = lower + pulseTaps;
+
+    const int first = base - half + 1;
+    const int kStart = juce::jmax (0, -first);
+    const int kEnd = juce::jmin (pulseTaps, numSamples - first);
+
+    for (int k = kStart; k < kEnd; ++k)
+        dest[first + k] += amplitude * (lower[k] + blend * (upper[k] - lower[k]));
+}
+
+void ExcitationGenerator::generateFrame (float* dest, int numSamples, int commitLength, double sampleRate, float pitchHz, float voicing) noexcept
+{
+    constexpr int half = pulseTaps / 2;
+
+    // Voiced share for this frame (power-complementary gains), ramped from the last one over the hop
+    const bool hasPitch = pitchHz > 0.0f && sampleRate > 0.0;
+    const float targetMix = hasPitch ? juce::jlimit (0.0f, 1.0f, (voicing - voicingLow) / (voicingHigh - voicingLow)) : 0.0f;
+    const int rampLength = juce::jlimit (1, numSamples, commitLength);
+    const float startMix = mix;
+    const float mixStep = (targetMix - startMix) / (float) rampLength;
+
+    // 1) Noise, scaled to unit power (uniform [-1, 1) has a variance of 1/3)
+    SIMDKernels::fillUniformNoise (dest, numSamples, seed, noiseIndex);
+
+    constexpr float noiseGain = 1.7320508f; // sqrt (3)
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        const float voicedShare = n < rampLength ? startMix + mixStep * (float) n : targetMix;
+        dest[n] *= noiseGain * std::sqrt (1.0f - voicedShare);
+    }
+
+    // 2) Pulses: keep the phase running across frames, adopting the new period at the frame start
+    if (hasPitch)
+        pulseIncrement = pitchHz / sampleRate;
+
+    if (pulseIncrement > 0.0 && (startMix > 0.0f || targetMix > 0.0f))
+    {
+        const double period = 1.0 / pulseIncrement;
+        const auto amplitude = (float) std::sqrt (period); // unit power at any period
+
+        // Pulse times relative to the frame start: the last one was pulsePhase periods ago
+        double position = -pulsePhase * period;
+        while (position - period > -half)
+            position -= period;
+
+        for (; position < numSamples + half; position += period)
+        {
+            const int centre = juce::jlimit (0, numSamples - 1, (int) std::lround (position));
+            const float voicedShare = centre < rampLength ? startMix + mixStep * (float) centre : targetMix;
+
+            if (voicedShare > 0.0f)
+                addPulse (dest, numSamples, position, amplitude * std::sqrt (voicedShare));
+        }
+    }
+
+    // 3) Commit the state reached after the first hop
+    noiseIndex += (uint32_t) commitLength;
+    mix = targetMix;
+
+    if (pulseIncrement > 0.0)
+    {
+        const double advanced = pulsePhase + pulseIncrement * commitLength;
+        pulsePhase = advanced - std::floor (advanced);
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <cstdint>
+
+/**
+    Source signal for one channel of LPC synthesis.
+
+    - Unvoiced: unit-power white noise from a counter-based hash
+      (SIMDKernels::fillUniformNoise). The stream position advances by one hop
+      per frame, so overlapping frames see the same noise in their overlap and
+      each channel gets its own deterministic stream from its seed.
+    - Voiced: a band-limited pulse train. Each pulse is a windowed-sinc kernel
+      placed at its exact fractional position from a small polyphase table,
+      and the pulse phase carries across frames, so the period neither resets
+      nor drifts when the pitch changes from hop to hop.
+    - In between: the two are mixed power-complementarily by the voicing
+      confidence, ramping from the previous frame's mix over the first hop.
+
+    Like LPCSynthesisFilter::processFrame(), generateFrame() renders a whole
+    frame but only commits the state reached after the first hop.
+*/
+class ExcitationGenerator
+{
+public:
+    ExcitationGenerator();
+
+    /** Chooses the noise stream (use a different seed per channel). Also resets. */
+    void setSeed (uint32_t newSeed) noexcept;
+
+    /** Restarts the noise stream, the pulse phase and the voicing mix. */
+    void reset() noexcept;
+
+    /** Voicing confidences at or below low give pure noise, at or above high pure pulses. */
+    void setVoicingRange (float low, float high) noexcept;
+
+    /** Writes numSamples of unit-power excitation into dest. The pulse phase, noise
+        position and mix are advanced by commitLength samples only.
+    */
+    void generateFrame (float* dest, int numSamples, int commitLength, double sampleRate, float pitchHz, float voicing) noexcept;
+
+private:
+    //==========================================================================
+    static constexpr int pulseTaps = 16; ///< kernel length in samples.
+    static constexpr int pulsePhases = 32; ///< fractional positions per sample.
+
+    /** Adds one band-limited pulse centred at time position (in samples). */
+    void addPulse (float* dest, int numSamples, double position, float amplitude) const noexcept;
+
+    std::array<float, (size_t) (pulsePhases + 1) * pulseTaps> pulseTable {};
+
+    uint32_t seed = 0;
+    uint32_t noiseIndex = 0;
+
+    double pulsePhase = 0.0; ///< fraction of the current period elapsed at the frame start.
+    double pulseIncrement = 0.0; ///< periods per sample of the last voiced frame.
+    float mix = 0.0f; ///< voiced share reached at the end of the last hop.
+
+    float voicingLow = 0.45f, voicingHigh = 0.75f;
+
+    JUCE_LEAK_DETECTOR (ExcitationGenerator)
+};
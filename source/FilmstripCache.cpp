@@ -0,0 +1,84 @@
+#include "FilmstripCache.h"
+
+#include <algorithm>
+
+//==============================================================================
+int FilmstripCache::getNumFrames (const juce::Image& strip) noexcept
+{
+    return strip.getWidth() > 0 ? juce::jmax (1, strip.getHeight() / strip.getWidth()) : 0;
+}
+
+FilmstripCache::ScaledStrip& FilmstripCache::findOrCreate (const juce::Image& strip, int pixelSize)
+{
+    ++useCounter;
+
+    for (auto& scaled : strips)
+    {
+        if (scaled.pixelSize == pixelSize && scaled.source == strip)
+        {
+            scaled.lastUsed = useCounter;
+            return scaled;
+        }
+    }
+
+    // A new size for this strip: make room by dropping its least recently used size
+    const auto isSameSource = [&strip] (const ScaledStrip& scaled) { return scaled.source == strip; };
+
+    if (std::count_if (strips.begin(), strips.end(), isSameSource) >= maxSizesPerStrip)
+    {
+        auto oldest = strips.end();
+
+        for (auto it = strips.begin(); it != strips.end(); ++it)
+            if (isSameSource (*it) && (oldest == strips.end() || it->lastUsed < oldest->lastUsed))
+                oldest = it;
+
+        strips.erase (oldest);
+    }
+
+    auto& scaled = strips.emplace_back();
+    scaled.source = strip;
+    scaled.pixelSize = pixelSize;
+    scaled.frames.resize ((size_t) getNumFrames (strip));
+    scaled.lastUsed = useCounter;
+    return scaled;
+}
+
+const juce::Image& FilmstripCache::getFrame (const juce::Image& strip, int frameIndex, int pixelSize)
+{
+    auto& scaled = findOrCreate (strip, pixelSize);
+    const int numFrames = (int) scaled.frames.size();
+    auto& frame = scaled.frames[(size_t) juce::jlimit (0, numFrames - 1, frameIndex)];
+
+    if (frame.isNull())
+    {
+        // Resample this one frame, once, with the best filter
+        const int sourceSize = strip.getWidth();
+        const int sourceY = juce::jlimit (0, numFrames - 1, frameIndex) * sourceSize;
+
+        frame = juce::Image (juce::Image::ARGB, pixelSize, pixelSize, true);
+        juce::Graphics g (frame);
+        g.setImageResamplingQuality (juce::Graphics::highResamplingQuality);
+        g.drawImage (strip, 0, 0, pixelSize, pixelSize, 0, sourceY, sourceSize, sourceSize);
+    }
+
+    return frame;
+}
+
+void FilmstripCache::drawFrame (juce::Graphics& g, const juce::Image& strip, float proportion, juce::Rectangle<int> area)
+{
+    const int numFrames = getNumFrames (strip);
+
+    if (numFrames == 0 || area.isEmpty())
+        return;
+
+    const auto square = area.withSizeKeepingCentre (juce::jmin (area.getWidth(), area.getHeight()),
+                                                    juce::jmin (area.getWidth(), area.getHeight()));
+
+    // Render at the physical pixel size, then undo the context's scale: a 1:1 blit
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const int pixelSize = juce::jmax (1, juce::roundToInt ((float) square.getWidth() * scale));
+    const int frameIndex = juce::roundToInt (juce::jlimit (0.0f, 1.0f, proportion) * (float) (numFrames - 1));
+
+    const auto& frame = getFrame (strip, frameIndex, pixelSize);
+    g.drawImageTransformed (frame, juce::AffineTransform::scale (1.0f / scale).translated ((float) square.getX(), (float) square.getY()));
+}
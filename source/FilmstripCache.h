@@ -0,0 +1,55 @@
+#pragma once
+
+#include <juce_graphics/juce_graphics.h>
+
+#include <cstdint>
+#include <vector>
+
+/**
+    Knob filmstrips (vertical strips of square frames) pre-scaled to the size they
+    are drawn at.
+
+    Drawing a sub-rectangle of the full strip with Graphics::drawImage resamples
+    the source on every repaint. Here each frame is rendered once, at the physical
+    pixel size of the knob (component size x display scale), and afterwards a
+    repaint is a single unscaled blit. A strip keeps its frames for the last few
+    sizes it was drawn at, so resizing the editor or moving it to another display
+    only costs a re-render of the frames that get shown.
+
+    One cache is shared by every look-and-feel (hold it in a
+    juce::SharedResourcePointer); like all painting it is message-thread only.
+*/
+class FilmstripCache
+{
+public:
+    FilmstripCache() = default;
+
+    /** Number of frames in a strip: its height over its width. */
+    static int getNumFrames (const juce::Image& strip) noexcept;
+
+    /** Draws the frame for a 0..1 position as a square, centred in area. */
+    void drawFrame (juce::Graphics& g, const juce::Image& strip, float proportion, juce::Rectangle<int> area);
+
+    /** The frame at a physical size in pixels (rendered on first use). */
+    const juce::Image& getFrame (const juce::Image& strip, int frameIndex, int pixelSize);
+
+private:
+    //==========================================================================
+    struct ScaledStrip
+    {
+        juce::Image source;
+        int pixelSize = 0;
+        std::vector<juce::Image> frames; ///< null until first drawn.
+        uint32_t lastUsed = 0;
+    };
+
+    /** Sizes kept per source strip before the least recently used one is dropped. */
+    static constexpr int maxSizesPerStrip = 4;
+
+    ScaledStrip& findOrCreate (const juce::Image& strip, int pixelSize);
+
+    std::vector<ScaledStrip> strips;
+    uint32_t useCounter = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FilmstripCache)
+};
@@ -0,0 +1,183 @@
+#include "LPCEngine.h"
+
+#include <cmath>
+
+//==============================================================================
+LPCEngine::LPCEngine (int lpcOrder, int windowSize)
+    : core (lpcOrder, windowSize)
+{
+}
+
+LPCEngine::~LPCEngine() = default;
+
+void LPCEngine::prepare (double newHostSampleRate, int maximumBlockSize, int numChannels)
+{
+    hostSampleRate = newHostSampleRate > 0.0 ? newHostSampleRate : 44100.0;
+    maxBlockSize = juce::jmax (1, maximumBlockSize);
+    numChannels = juce::jmax (0, numChannels);
+
+    // Ratios p / q with p <= maxUpFactor and rates down to minTargetSampleRate
+    const int maxDownFactor = (int) std::ceil (maxUpFactor * hostSampleRate / minTargetSampleRate);
+
+    downsampler.prepare (numChannels, maxBlockSize, maxUpFactor, maxDownFactor, resamplerQuality);
+    const int maxReducedBlock = maxBlockSize + 1; // never more samples than the host block (+1 for phase)
+
+    upsampler.prepare (numChannels, maxReducedBlock, maxDownFactor, maxUpFactor, resamplerQuality);
+
+    reduced.assign ((size_t) numChannels, std::vector<float> ((size_t) maxReducedBlock, 0.0f));
+    reducedPointers.resize ((size_t) numChannels);
+
+    // Up to one host block of leftovers, the next block's output, and the pre-fill
+    const int pendingCapacity = 3 * maxBlockSize + 2 * maxDownFactor + 16;
+    pending.assign ((size_t) numChannels, std::vector<float> ((size_t) pendingCapacity, 0.0f));
+    pendingPointers.resize ((size_t) numChannels);
+
+    for (size_t ch = 0; ch < (size_t) numChannels; ++ch)
+        reducedPointers[ch] = reduced[ch].data();
+
+    core.prepare (hostSampleRate, maxReducedBlock, numChannels);
+
+    upFactor = downFactor = 0; // force the ratio to be applied
+    setTargetSampleRate (targetSampleRate);
+}
+
+void LPCEngine::reset()
+{
+    downsampler.reset();
+    upsampler.reset();
+    core.reset();
+
+    for (auto& channel : pending)
+        std::fill (channel.begin(), channel.end(), 0.0f);
+
+    // The reduced-rate sample count per host block wanders by a sample or two,
+    // so start with enough silence queued that a full block is always available
+    numPending = isResampling() ? fifoPrefill : 0;
+}
+
+void LPCEngine::setTargetSampleRate (double newTargetRate)
+{
+    targetSampleRate = juce::jlimit (minTargetSampleRate, hostSampleRate, newTargetRate);
+
+    int newUp = 1, newDown = 1;
+    PolyphaseResampler::approximateRatio (hostSampleRate, targetSampleRate, maxUpFactor, newUp, newDown);
+
+    // An approximation may land just below the lowest rate; stop there, so that
+    // getMaxLatencySamples() really is the largest latency
+    int lowestUp = 1, lowestDown = 1;
+    getLowestRateRatio (lowestUp, lowestDown);
+
+    if ((long long) newUp * lowestDown < (long long) lowestUp * newDown)
+    {
+        newUp = lowestUp;
+        newDown = lowestDown;
+    }
+
+    if (newUp >= newDown)
+        newUp = newDown = 1; // at (or above) the host rate: run the core directly
+
+    if (newUp == upFactor && newDown == downFactor)
+        return;
+
+    upFactor = newUp;
+    downFactor = newDown;
+
+    downsampler.setRatio (upFactor, downFactor);
+    upsampler.setRatio (downFactor, upFactor);
+    core.setTargetSampleRate (getEffectiveSampleRate());
+
+    fifoPrefill = (downFactor + upFactor - 1) / upFactor + 2;
+
+    updateLatency();
+    reset();
+}
+
+void LPCEngine::setSynthesisMode (LPCProcessor::SynthesisMode newMode, int interpolatedHopSize)
+{
+    core.setSynthesisMode (newMode, interpolatedHopSize);
+    updateLatency();
+    reset();
+}
+
+void LPCEngine::updateLatency() noexcept
+{
+    latencySamples = computeLatency (upFactor, downFactor);
+}
+
+int LPCEngine::computeLatency (int up, int down) const noexcept
+{
+    if (up == down)
+        return core.getLatencySamples();
+
+    const auto quality = downsampler.getQuality();
+    const double reducedToHost = (double) down / (double) up;
+    const double reducedDelay = core.getLatencySamples() + PolyphaseResampler::getLatencyInInputSamples (down, up, quality);
+    const int prefill = (down + up - 1) / up + 2;
+
+    return (int) std::lround (PolyphaseResampler::getLatencyInInputSamples (up, down, quality) + reducedDelay * reducedToHost + prefill);
+}
+
+void LPCEngine::getLowestRateRatio (int& up, int& down) const noexcept
+{
+    PolyphaseResampler::approximateRatio (hostSampleRate, minTargetSampleRate, maxUpFactor, up, down);
+
+    if (up >= down)
+        up = down = 1;
+}
+
+int LPCEngine::getMaxLatencySamples() const noexcept
+{
+    // Every term grows with the decimation ratio, so the lowest rate has the most latency
+    int up = 1, down = 1;
+    getLowestRateRatio (up, down);
+    return computeLatency (up, down);
+}
+
+//==============================================================================
+void LPCEngine::process (juce::AudioBuffer<float>& buffer)
+{
+    const int numChannels = juce::jmin (buffer.getNumChannels(), (int) reduced.size());
+    const int numSamples = buffer.getNumSamples();
+    jassert (numSamples <= maxBlockSize); // call prepare() with the real block size
+    jassert (numChannels == (int) reduced.size()); // the resamplers run every prepared channel
+
+    if (! isResampling())
+    {
+        core.process (buffer, buffer);
+        return;
+    }
+
+    // 1) Down to the LPC rate
+    const int numReduced = downsampler.process (buffer.getArrayOfReadPointers(), numSamples, reducedPointers.data());
+
+    // 2) LPC analysis + synthesis at the reduced rate (a view, no allocation)
+    if (numReduced > 0)
+    {
+        juce::AudioBuffer<float> reducedView (reducedPointers.data(), numChannels, numReduced);
+        core.process (reducedView, reducedView);
+    }
+
+    // 3) Back up to the host rate, appended to the output FIFO
+    for (size_t ch = 0; ch < pending.size(); ++ch)
+        pendingPointers[ch] = pending[ch].data() + numPending;
+
+    jassert (numPending + upsampler.getMaxOutputSamples (numReduced) <= (int) pending.front().size());
+    numPending += upsampler.process (reducedPointers.data(), numReduced, pendingPointers.data());
+
+    // 4) Hand a full block to the host and keep the remainder
+    const int numReady = juce::jmin (numPending, numSamples);
+    jassert (numReady == numSamples); // the pre-fill should always cover a block
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& channel = pending[(size_t) ch];
+        buffer.copyFrom (ch, 0, channel.data(), numReady);
+
+        if (numReady < numSamples)
+            buffer.clear (ch, numReady, numSamples - numReady);
+
+        std::copy (channel.begin() + numReady, channel.begin() + numPending, channel.begin());
+    }
+
+    numPending -= numReady;
+}
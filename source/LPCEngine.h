@@ -0,0 +1,116 @@
+#pragma once
+
+#include "LPCProcessor.h"
+#include "PolyphaseResampler.h"
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <vector>
+
+/**
+    Runs LPCProcessor at a reduced sample rate.
+
+    The host signal is resampled down to the LPC rate by a polyphase
+    resampler, analysed and re-synthesized by the LPC core there, then
+    resampled back up to the host rate. Everything the LPC core does
+    (autocorrelation, recursion, synthesis) therefore costs roughly
+    lpcRate / hostRate of the full-rate path, and the result is genuinely
+    band-limited to the reduced rate.
+
+    The LPC rate is the requested rate approximated by a ratio p / q of the
+    host rate with p <= maxUpFactor, so 48k -> 8k (1/6) and 44.1k -> 11.025k
+    (1/4) are exact and anything else is within a few Hz. A rate at or above
+    the host rate bypasses the resamplers.
+
+    The number of reduced-rate samples per host block varies by one or two, so
+    the upsampled output passes through a small FIFO that is pre-filled with
+    enough silence to always cover a full host block.
+*/
+class LPCEngine
+{
+public:
+    /** Largest numerator of the host -> LPC rate ratio (bounds the filter tables). */
+    static constexpr int maxUpFactor = 64;
+
+    /** Lowest LPC rate the engine is prepared for (the LPC_SAMPLE_RATE minimum). */
+    static constexpr double minTargetSampleRate = 4000.0;
+
+    LPCEngine (int lpcOrder, int windowSize);
+    ~LPCEngine();
+
+    //==========================================================================
+    /** Allocates everything for the host rate, block size and channel count (off the audio thread). */
+    void prepare (double newHostSampleRate, int maximumBlockSize, int numChannels);
+
+    /** Clears the resamplers, output FIFO and LPC state. */
+    void reset();
+
+    /** Picks the resampling ratio for the requested LPC rate (LPC_SAMPLE_RATE).
+        Changing the ratio redesigns the filters and resets the signal path, but never allocates.
+    */
+    void setTargetSampleRate (double newTargetRate);
+
+    /** Anti-aliasing / anti-imaging filter quality (takes effect on the next prepare()). */
+    void setResamplerQuality (PolyphaseResampler::Quality newQuality) noexcept { resamplerQuality = newQuality; }
+
+    /** Forwarded to the LPC core. */
+    void setLpcOrder (int newOrder) { core.setLpcOrder (newOrder); }
+    void setPitchDetectionEnabled (bool shouldEnable) { core.setPitchDetectionEnabled (shouldEnable); }
+
+    /** Forwarded to the LPC core (off the audio thread); the latency follows. */
+    void setSynthesisMode (LPCProcessor::SynthesisMode newMode, int interpolatedHopSize = 0);
+
+    LPCProcessor& getLPCProcessor() noexcept { return core; }
+
+    double getEffectiveSampleRate() const noexcept { return hostSampleRate * upFactor / downFactor; }
+
+    /** One LPC hop, measured in host samples. */
+    int getHopSizeInHostSamples() const noexcept { return (core.getHopSize() * downFactor + upFactor - 1) / upFactor; }
+
+    /** Host-rate latency: one LPC window at the reduced rate, plus the resampling filters and FIFO. */
+    int getLatencySamples() const noexcept { return latencySamples; }
+
+    /** The latency at the lowest LPC rate (the highest any rate has), for the current
+        window, synthesis mode and host rate. Call after prepare().
+    */
+    int getMaxLatencySamples() const noexcept;
+
+    //==========================================================================
+    /** Processes the buffer in place. Any block size up to the prepared maximum. */
+    void process (juce::AudioBuffer<float>& buffer);
+
+private:
+    //==========================================================================
+    bool isResampling() const noexcept { return upFactor != downFactor; }
+
+    void updateLatency() noexcept;
+
+    /** Latency of the signal path for a host -> LPC ratio. */
+    int computeLatency (int up, int down) const noexcept;
+
+    /** The host -> LPC ratio for minTargetSampleRate (the largest decimation used). */
+    void getLowestRateRatio (int& up, int& down) const noexcept;
+
+    //==========================================================================
+    LPCProcessor core;
+    PolyphaseResampler downsampler, upsampler;
+    PolyphaseResampler::Quality resamplerQuality = PolyphaseResampler::Quality::medium;
+
+    double hostSampleRate = 44100.0;
+    double targetSampleRate = 44100.0;
+    int upFactor = 1, downFactor = 1; ///< LPC rate = host rate * upFactor / downFactor.
+    int maxBlockSize = 0;
+    int latencySamples = 0;
+
+    // Reduced-rate block (one row per channel):
+    std::vector<std::vector<float>> reduced;
+    std::vector<float*> reducedPointers;
+
+    // Upsampled output waiting to be handed to the host:
+    std::vector<std::vector<float>> pending;
+    std::vector<float*> pendingPointers;
+    int numPending = 0;
+    int fifoPrefill = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LPCEngine)
+};
@@ -0,0 +1,320 @@
+#include "LPCEngineManager.h"
+
+#include <cmath>
+
+//==============================================================================
+LPCEngineManager::LPCEngineManager()
+    : juce::Thread ("LPC engine builder")
+{
+}
+
+LPCEngineManager::~LPCEngineManager()
+{
+    release();
+
+    delete incoming.exchange (nullptr);
+    delete retired.exchange (nullptr);
+}
+
+//==============================================================================
+void LPCEngineManager::prepare (double newHostSampleRate, int maximumBlockSize, int newNumChannels, const Config& config)
+{
+    release();
+
+    delete incoming.exchange (nullptr);
+    delete retired.exchange (nullptr);
+    next.reset();
+
+    hostSampleRate = newHostSampleRate;
+    maxBlockSize = juce::jmax (1, maximumBlockSize);
+    numChannels = juce::jmax (0, newNumChannels);
+
+    fadeBuffer.assign ((size_t) numChannels, std::vector<float> ((size_t) maxBlockSize, 0.0f));
+    fadePointers.resize ((size_t) numChannels);
+
+    for (size_t ch = 0; ch < fadeBuffer.size(); ++ch)
+        fadePointers[ch] = fadeBuffer[ch].data();
+
+    // The first engine is built right here, so the plugin can play straight away
+    lastRequested = config;
+    builtConfig = config;
+    builtGeneration = requestGeneration.load();
+
+    active = createEngine (config);
+    latencySamples.store (active->getLatencySamples());
+
+    // Room to delay the quickest engine to the slowest (the lowest LPC rate's)
+    activeAlignment.prepare (numChannels, active->getMaxLatencySamples(), maxBlockSize);
+    nextAlignment.prepare (numChannels, active->getMaxLatencySamples(), maxBlockSize);
+    activeDelay = nextDelay = 0;
+    stepFromDelay = stepPosition = stepLength = 0;
+
+    startThread();
+}
+
+void LPCEngineManager::release()
+{
+    signalThreadShouldExit();
+    wakeBuilder();
+    stopThread (1000);
+}
+
+void LPCEngineManager::wakeBuilder() noexcept
+{
+    builderWakeUps.fetch_add (1, std::memory_order_release);
+    builderWakeUps.notify_one();
+}
+
+void LPCEngineManager::requestConfig (const Config& config) noexcept
+{
+    if (config == lastRequested)
+        return;
+
+    lastRequested = config;
+
+    // The generation is bumped last, so the builder sees at least these values.
+    // If it reads them halfway through a later request, that request bumps the
+    // generation again and the builder simply builds once more.
+    requestedOrder.store (config.lpcOrder, std::memory_order_relaxed);
+    requestedWindowSize.store (config.windowSize, std::memory_order_relaxed);
+    requestedSampleRate.store (config.targetSampleRate, std::memory_order_relaxed);
+    requestedSynthesisMode.store ((int) config.synthesisMode, std::memory_order_relaxed);
+    requestedHopSize.store (config.interpolatedHopSize, std::memory_order_relaxed);
+    requestGeneration.fetch_add (1, std::memory_order_release);
+    wakeBuilder();
+}
+
+LPCEngineManager::Config LPCEngineManager::loadRequestedConfig() const noexcept
+{
+    Config config;
+    config.lpcOrder = requestedOrder.load (std::memory_order_relaxed);
+    config.windowSize = requestedWindowSize.load (std::memory_order_relaxed);
+    config.targetSampleRate = requestedSampleRate.load (std::memory_order_relaxed);
+    config.synthesisMode = (LPCProcessor::SynthesisMode) requestedSynthesisMode.load (std::memory_order_relaxed);
+    config.interpolatedHopSize = requestedHopSize.load (std::memory_order_relaxed);
+    return config;
+}
+
+//==============================================================================
+void LPCEngineManager::run()
+{
+    while (! threadShouldExit())
+    {
+        // Read before looking for work, so a wake-up that arrives meanwhile isn't lost
+        const auto wakeUps = builderWakeUps.load (std::memory_order_acquire);
+
+        reclaimRetiredEngine();
+
+        // Only one engine waits for the audio thread at a time; later requests are
+        // picked up once it has been taken, and only the newest one is built
+        const auto generation = requestGeneration.load (std::memory_order_acquire);
+
+        if (generation != builtGeneration && incoming.load (std::memory_order_acquire) == nullptr)
+        {
+            const auto config = loadRequestedConfig();
+            builtGeneration = generation;
+
+            if (config != builtConfig)
+            {
+                builtConfig = config;
+                incoming.store (createEngine (config).release(), std::memory_order_release);
+            }
+        }
+
+        builderWakeUps.wait (wakeUps, std::memory_order_acquire);
+    }
+}
+
+std::unique_ptr<LPCEngine> LPCEngineManager::createEngine (const Config& config) const
+{
+    // All the allocation and filter design of a reconfiguration happens here
+    auto engine = std::make_unique<LPCEngine> (config.lpcOrder, config.windowSize);
+    engine->setSynthesisMode (config.synthesisMode, config.interpolatedHopSize);
+    engine->prepare (hostSampleRate, maxBlockSize, numChannels);
+    engine->setTargetSampleRate (config.targetSampleRate);
+    engine->setPitchDetectionEnabled (pitchDetectionEnabled.load (std::memory_order_relaxed));
+    return engine;
+}
+
+void LPCEngineManager::reclaimRetiredEngine()
+{
+    delete retired.exchange (nullptr, std::memory_order_acq_rel);
+}
+
+//==============================================================================
+void LPCEngineManager::AlignmentDelay::prepare (int numChannels, int maxDelay, int maxBlockSize)
+{
+    const auto capacity = (size_t) juce::nextPowerOfTwo (juce::jmax (1, maxDelay + maxBlockSize));
+    rings.assign ((size_t) juce::jmax (0, numChannels), std::vector<float> (capacity, 0.0f));
+    writePosition = 0;
+}
+
+void LPCEngineManager::AlignmentDelay::process (float* const* channels, int numChannels, int numSamples,
+                                                int fromDelay, int delay, int fadePosition, int fadeLength) noexcept
+{
+    numChannels = juce::jmin (numChannels, (int) rings.size());
+
+    if (numChannels == 0)
+        return;
+
+    // The history is always kept, so a delay can start from real output
+    const int capacity = (int) rings.front().size();
+    const int mask = capacity - 1;
+    const bool fading = fadePosition < fadeLength;
+    jassert (delay + numSamples <= capacity && fromDelay + numSamples <= capacity); // prepared for a smaller window
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& ring = rings[(size_t) ch];
+        float* data = channels[ch];
+
+        for (int i = 0; i < numSamples; ++i)
+            ring[(size_t) ((writePosition + i) & mask)] = data[i];
+
+        if (delay == 0 && ! fading)
+            continue;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const int position = writePosition + i;
+            float sample = ring[(size_t) ((position - delay) & mask)];
+
+            // The same signal either side, so a linear fade keeps the level
+            if (fadePosition + i < fadeLength)
+            {
+                const float t = ((float) (fadePosition + i) + 0.5f) / (float) fadeLength;
+                sample = t * sample + (1.0f - t) * ring[(size_t) ((position - fromDelay) & mask)];
+            }
+
+            data[i] = sample;
+        }
+    }
+
+    writePosition = (writePosition + numSamples) & mask;
+}
+
+//==============================================================================
+void LPCEngineManager::beginLatencyStep (int newDelay, int length) noexcept
+{
+    stepFromDelay = activeDelay;
+    activeDelay = newDelay;
+    stepPosition = 0;
+    stepLength = juce::jmax (1, length);
+    latencySamples.store (active->getLatencySamples() + activeDelay, std::memory_order_relaxed);
+}
+
+void LPCEngineManager::beginSwitch() noexcept
+{
+    // The retired slot must be free for the engine this switch will replace
+    if (retired.load (std::memory_order_acquire) != nullptr)
+        return;
+
+    auto* engine = incoming.exchange (nullptr, std::memory_order_acq_rel);
+
+    if (engine == nullptr)
+        return;
+
+    next.reset (engine);
+    fadeLength = juce::jmax (1, engine->getHopSizeInHostSamples());
+    fadePosition = 0;
+
+    // Both engines are heard at the slower one's latency while they switch: the
+    // new one through a fixed delay, the old one through a delay faded in now
+    const int activeLatency = active->getLatencySamples();
+    const int alignedLatency = juce::jmax (activeLatency, engine->getLatencySamples());
+    nextDelay = alignedLatency - engine->getLatencySamples();
+
+    if (alignedLatency > activeLatency)
+        beginLatencyStep (alignedLatency - activeLatency, fadeLength);
+
+    // A fresh engine is silent until its (aligned) latency has passed, so it only
+    // starts fading in once it has caught up with the one it replaces. The old
+    // engine's delay step (one hop) is over by then.
+    warmUpRemaining = alignedLatency;
+}
+
+void LPCEngineManager::processActive (juce::AudioBuffer<float>& buffer) noexcept
+{
+    const int numSamples = buffer.getNumSamples();
+    active->process (buffer);
+
+    activeAlignment.process (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), numSamples,
+                             stepFromDelay, activeDelay, stepPosition, stepLength);
+    stepPosition = juce::jmin (stepLength, stepPosition + numSamples);
+}
+
+void LPCEngineManager::process (juce::AudioBuffer<float>& buffer) noexcept
+{
+    if (active == nullptr)
+        return;
+
+    const bool pitchDetection = pitchDetectionEnabled.load (std::memory_order_relaxed);
+    active->setPitchDetectionEnabled (pitchDetection);
+
+    // Once the new engine runs alone, its alignment delay fades back out, and only
+    // then can the next switch start. Both happen on a block boundary, so the dry
+    // path sees the latency step at the same sample.
+    if (next == nullptr && activeDelay != 0 && stepPosition >= stepLength)
+        beginLatencyStep (0, active->getHopSizeInHostSamples());
+
+    if (! isSwitching())
+        beginSwitch();
+
+    if (next == nullptr)
+    {
+        processActive (buffer);
+        return;
+    }
+
+    // Switching: the incoming engine runs on a copy of the input
+    const int numSamples = buffer.getNumSamples();
+    const int numFadeChannels = juce::jmin (buffer.getNumChannels(), (int) fadeBuffer.size());
+
+    for (int ch = 0; ch < numFadeChannels; ++ch)
+        std::copy_n (buffer.getReadPointer (ch), numSamples, fadePointers[(size_t) ch]);
+
+    juce::AudioBuffer<float> incomingView (fadePointers.data(), numFadeChannels, numSamples);
+    next->setPitchDetectionEnabled (pitchDetection);
+    next->process (incomingView);
+    nextAlignment.process (fadePointers.data(), numFadeChannels, numSamples, nextDelay, nextDelay, 0, 0);
+    processActive (buffer);
+
+    // Old engine only while the new one warms up, then an equal-power crossfade
+    // (the two outputs are far from identical), then the new engine only
+    const int fadeStart = juce::jmin (warmUpRemaining, numSamples);
+    const int fadeCount = juce::jmin (numSamples - fadeStart, fadeLength - fadePosition);
+    warmUpRemaining -= fadeStart;
+
+    for (int n = 0; n < fadeCount; ++n)
+    {
+        const float t = ((float) (fadePosition + n) + 0.5f) / (float) fadeLength;
+        const float angle = 0.5f * juce::MathConstants<float>::pi * t;
+        const float oldGain = std::cos (angle);
+        const float newGain = std::sin (angle);
+
+        for (int ch = 0; ch < numFadeChannels; ++ch)
+        {
+            float* out = buffer.getWritePointer (ch);
+            out[fadeStart + n] = oldGain * out[fadeStart + n] + newGain * fadePointers[(size_t) ch][fadeStart + n];
+        }
+    }
+
+    fadePosition += fadeCount;
+    const int fadeEnd = fadeStart + fadeCount;
+
+    if (fadeEnd < numSamples)
+        for (int ch = 0; ch < numFadeChannels; ++ch)
+            buffer.copyFrom (ch, fadeEnd, fadePointers[(size_t) ch] + fadeEnd, numSamples - fadeEnd);
+
+    if (warmUpRemaining == 0 && fadePosition >= fadeLength)
+    {
+        // The old engine is deleted by the background thread, never here. The new
+        // one keeps its delay (and the latency stays put) until the next block.
+        retired.store (active.release(), std::memory_order_release);
+        wakeBuilder();
+        active = std::move (next);
+        std::swap (activeAlignment, nextAlignment);
+        activeDelay = nextDelay;
+        stepPosition = stepLength;
+    }
+}
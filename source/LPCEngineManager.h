@@ -0,0 +1,185 @@
+#pragma once
+
+#include "LPCEngine.h"
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+    Swaps LPCEngines without reconfiguring anything on the audio thread.
+
+    The audio thread only posts the requested configuration (a few atomics and
+    a generation counter) and wakes a background thread, which builds and
+    prepares a complete engine for it and hands it over through an atomic
+    pointer. The audio thread then runs the new engine next to the old one
+    until the new one's latency has elapsed (so it has real output to offer),
+    crossfades over one of its hops, and hands the old engine back through a
+    second atomic pointer for the background thread to delete.
+
+    Each engine runs at its own latency. While two engines with different
+    latencies hand over, the quicker one is delayed to match the slower, so the
+    crossfade blends outputs that line up sample for sample. The delay is faded
+    in (on the old engine, before the crossfade) or out (on the new one, after
+    it) over one hop; getLatencySamples() follows each of those steps, so the
+    dry path can crossfade across them too. The host's latency only needs
+    updating once isSwitching() is false again.
+
+    At most one engine is waiting and one is fading in at any time, so however
+    fast a parameter is automated, a block costs at most two engines' worth of
+    processing, and never an allocation.
+*/
+class LPCEngineManager : private juce::Thread
+{
+public:
+    /** Everything that needs a new engine when it changes. */
+    struct Config
+    {
+        int lpcOrder = 16;
+        int windowSize = 512;
+        double targetSampleRate = 8000.0;
+        LPCProcessor::SynthesisMode synthesisMode = LPCProcessor::SynthesisMode::overlapAdd;
+        int interpolatedHopSize = 0;
+
+        bool operator== (const Config& other) const noexcept
+        {
+            return lpcOrder == other.lpcOrder && windowSize == other.windowSize
+                   && targetSampleRate == other.targetSampleRate && synthesisMode == other.synthesisMode
+                   && interpolatedHopSize == other.interpolatedHopSize;
+        }
+
+        bool operator!= (const Config& other) const noexcept { return ! operator== (other); }
+    };
+
+    LPCEngineManager();
+    ~LPCEngineManager() override;
+
+    //==========================================================================
+    /** Builds the engine for the config synchronously and starts the background
+        thread. Call off the audio thread, e.g. from prepareToPlay().
+    */
+    void prepare (double newHostSampleRate, int maximumBlockSize, int numChannels, const Config& config);
+
+    /** Stops the background thread (prepare() restarts it). */
+    void release();
+
+    /** Asks for an engine with a new config (audio thread safe, lock-free). The
+        current engine keeps running until the new one has been built and faded in.
+    */
+    void requestConfig (const Config& config) noexcept;
+
+    /** Applied straight to the running engines; no rebuild needed. */
+    void setPitchDetectionEnabled (bool shouldEnable) noexcept { pitchDetectionEnabled.store (shouldEnable, std::memory_order_relaxed); }
+
+    /** Latency of the output as it is being heard, alignment delay included (may be read
+        from any thread). Steps to a new value at the start of a block while switching.
+    */
+    int getLatencySamples() const noexcept { return latencySamples.load (std::memory_order_relaxed); }
+
+    /** How long the latest latency step takes to fade across, in samples (audio thread). */
+    int getLatencyStepLength() const noexcept { return stepLength; }
+
+    /** True from the start of a switch until the new engine runs on its own, undelayed (audio thread). */
+    bool isSwitching() const noexcept { return next != nullptr || activeDelay != 0 || stepPosition < stepLength; }
+
+    /** True once an engine for a new config has been built and the next process() call
+        will start switching to it (lets tests wait for a handover outside the audio path).
+    */
+    bool isIncomingEngineReady() const noexcept
+    {
+        return incoming.load (std::memory_order_acquire) != nullptr && retired.load (std::memory_order_acquire) == nullptr;
+    }
+
+    //==========================================================================
+    /** Processes the buffer in place through the current engine (and the incoming one while switching). */
+    void process (juce::AudioBuffer<float>& buffer) noexcept;
+
+private:
+    //==========================================================================
+    void run() override;
+
+    /** A new engine, prepared for the current host settings. */
+    std::unique_ptr<LPCEngine> createEngine (const Config& config) const;
+
+    Config loadRequestedConfig() const noexcept;
+
+    /** Deletes an engine the audio thread has finished with, if there is one. */
+    void reclaimRetiredEngine();
+
+    /** Wakes the background thread without locking anything (safe on the audio thread). */
+    void wakeBuilder() noexcept;
+
+    /** Picks up a published engine and starts warming it up (audio thread). */
+    void beginSwitch() noexcept;
+
+    /** Starts moving the active engine's alignment delay to a new length (audio thread). */
+    void beginLatencyStep (int newDelay, int length) noexcept;
+
+    /** Runs the active engine and its alignment delay in place. */
+    void processActive (juce::AudioBuffer<float>& buffer) noexcept;
+
+    //==========================================================================
+    /** Delays an engine's output by a variable amount (one ring per channel). */
+    struct AlignmentDelay
+    {
+        void prepare (int numChannels, int maxDelay, int maxBlockSize);
+
+        /** Writes the block in, then replaces it with the samples 'delay' ago, fading
+            linearly from 'fromDelay' over fadeLength samples starting at fadePosition.
+        */
+        void process (float* const* channels, int numChannels, int numSamples,
+                      int fromDelay, int delay, int fadePosition, int fadeLength) noexcept;
+
+        std::vector<std::vector<float>> rings; ///< power-of-two length.
+        int writePosition = 0;
+    };
+
+    //==========================================================================
+    // Owned by the audio thread (or by prepare() while audio is stopped)
+    std::unique_ptr<LPCEngine> active, next;
+    int warmUpRemaining = 0; ///< samples until 'next' produces real output.
+    int fadePosition = 0, fadeLength = 0;
+
+    // Delays that line the two engines up while they switch
+    AlignmentDelay activeAlignment, nextAlignment;
+    int activeDelay = 0, nextDelay = 0;
+    int stepFromDelay = 0, stepPosition = 0, stepLength = 0; ///< the active delay fading from stepFromDelay.
+    Config lastRequested;
+
+    // Handover between the threads (each slot holds at most one engine)
+    std::atomic<LPCEngine*> incoming { nullptr }; ///< built, waiting for the audio thread.
+    std::atomic<LPCEngine*> retired { nullptr }; ///< faded out, waiting to be deleted.
+
+    // Latest request, posted by the audio thread and read by the background thread
+    std::atomic<int> requestedOrder { 16 }, requestedWindowSize { 512 }, requestedHopSize { 0 };
+    std::atomic<double> requestedSampleRate { 8000.0 };
+    std::atomic<int> requestedSynthesisMode { 0 };
+    std::atomic<uint32_t> requestGeneration { 0 };
+
+    // Bumped on every new request, retired engine and shutdown; the background
+    // thread sleeps on it (std::atomic::wait) rather than polling. Unlike a
+    // WaitableEvent, notifying it never takes a lock on the audio thread.
+    std::atomic<uint32_t> builderWakeUps { 0 };
+
+    std::atomic<bool> pitchDetectionEnabled { false };
+    std::atomic<int> latencySamples { 0 };
+
+    // Owned by the background thread: what the newest engine was built for
+    Config builtConfig;
+    uint32_t builtGeneration = 0;
+
+    // Host settings every engine is prepared for (fixed while the thread runs)
+    double hostSampleRate = 44100.0;
+    int maxBlockSize = 0;
+    int numChannels = 0;
+
+    // Output of the incoming engine while switching:
+    std::vector<std::vector<float>> fadeBuffer;
+    std::vector<float*> fadePointers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LPCEngineManager)
+};
@@ -0,0 +1,54 @@
+#include "LPCFrameArena.h"
+
+#include <algorithm>
+
+void LPCFrameArena::allocate (int maxFrames, int newWindowSize, int maxOrder)
+{
+    maxFrames = juce::jmax (1, maxFrames);
+    newWindowSize = juce::jmax (1, newWindowSize);
+    maxOrder = juce::jmax (1, maxOrder);
+
+    if (maxFrames <= frameCapacity && newWindowSize == windowSize && maxOrder <= orderCapacity)
+        return;
+
+    // Growing the arena means a heap allocation: that must never happen while the
+    // audio thread is using it. Size it in prepare()/setWindowSize() instead.
+    jassert (! isRealtimeLocked());
+
+    frameCapacity = juce::jmax (frameCapacity, maxFrames);
+    orderCapacity = juce::jmax (orderCapacity, maxOrder);
+    windowSize = newWindowSize;
+
+    windowStride = roundUpToAlignment ((size_t) windowSize);
+    orderStride = roundUpToAlignment ((size_t) orderCapacity);
+
+    const auto frames = (size_t) frameCapacity;
+    const auto perFrameStride = roundUpToAlignment (frames);
+
+    const size_t totalFloats = 2 * frames * windowStride // stacked + synthesized
+                               + 2 * frames * orderStride // coefficients + reflections
+                               + 3 * perFrameStride // powers + pitches + voicing
+                               + windowStride; // scratch
+
+    storage.reset (static_cast<float*> (::operator new[] (totalFloats * sizeof (float), std::align_val_t { alignmentBytes })));
+    std::fill_n (storage.get(), totalFloats, 0.0f);
+
+    auto* p = storage.get();
+    stackedFrames = p;
+    p += frames * windowStride;
+    synthesizedFrames = p;
+    p += frames * windowStride;
+    coefficients = p;
+    p += frames * orderStride;
+    reflections = p;
+    p += frames * orderStride;
+    powers = p;
+    p += perFrameStride;
+    pitches = p;
+    p += perFrameStride;
+    voicing = p;
+    p += perFrameStride;
+    scratch = p;
+
+    numFrames = 0;
+}
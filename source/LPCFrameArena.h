@@ -0,0 +1,119 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+/**
+    Contiguous, preallocated storage for everything LPCProcessor produces per frame.
+
+    All per-frame data lives in one 64-byte aligned block, laid out as a
+    structure of arrays:
+    - frames x window : windowed analysis frames
+    - frames x window : synthesized frames
+    - frames x order  : LPC coefficients
+    - frames x order  : reflection coefficients
+    - frames          : signal powers
+    - frames          : pitch estimates (Hz)
+    - frames          : voicing confidence (0..1)
+    - window          : scratch space (excitation etc.)
+
+    Every row starts on a 64-byte boundary so the kernels can use aligned SIMD
+    loads. The arena is sized off the audio thread via allocate(); while a
+    ScopedRealtimeLock is alive (i.e. inside LPCProcessor::process) any attempt
+    to grow it trips an assertion in debug builds.
+*/
+class LPCFrameArena
+{
+public:
+    LPCFrameArena() = default;
+    ~LPCFrameArena() = default;
+
+    //==========================================================================
+    /** Makes room for at least the given dimensions. Only reallocates when one
+        of them grows beyond the current capacity, and never shrinks.
+    */
+    void allocate (int maxFrames, int windowSize, int maxOrder);
+
+    /** Sets how many frames the current chunk uses (must not exceed capacity). */
+    void setNumFrames (int newNumFrames) noexcept
+    {
+        jassert (newNumFrames >= 0 && newNumFrames <= frameCapacity);
+        numFrames = newNumFrames;
+    }
+
+    int getNumFrames() const noexcept { return numFrames; }
+    int getFrameCapacity() const noexcept { return frameCapacity; }
+    int getWindowSize() const noexcept { return windowSize; }
+
+    //==========================================================================
+    float* getFrame (int frameIndex) noexcept { return stackedFrames + rowOffset (frameIndex, windowStride); }
+    float* getSynthesized (int frameIndex) noexcept { return synthesizedFrames + rowOffset (frameIndex, windowStride); }
+    float* getCoefficients (int frameIndex) noexcept { return coefficients + rowOffset (frameIndex, orderStride); }
+    float* getReflections (int frameIndex) noexcept { return reflections + rowOffset (frameIndex, orderStride); }
+    float* getPowers() noexcept { return powers; }
+    float* getPitches() noexcept { return pitches; }
+    float* getVoicing() noexcept { return voicing; }
+    float* getScratch() noexcept { return scratch; }
+
+    //==========================================================================
+    /** Marks the arena as in use by the audio thread for the lifetime of this object. */
+    class ScopedRealtimeLock
+    {
+    public:
+        explicit ScopedRealtimeLock (LPCFrameArena& a) noexcept : arena (a) { ++arena.realtimeDepth; }
+        ~ScopedRealtimeLock() noexcept { --arena.realtimeDepth; }
+
+    private:
+        LPCFrameArena& arena;
+        JUCE_DECLARE_NON_COPYABLE (ScopedRealtimeLock)
+    };
+
+    bool isRealtimeLocked() const noexcept { return realtimeDepth > 0; }
+
+private:
+    //==========================================================================
+    static constexpr size_t alignmentBytes = 64;
+    static constexpr size_t floatsPerAlignment = alignmentBytes / sizeof (float);
+
+    static size_t roundUpToAlignment (size_t numFloats) noexcept
+    {
+        return (numFloats + floatsPerAlignment - 1) / floatsPerAlignment * floatsPerAlignment;
+    }
+
+    size_t rowOffset (int frameIndex, size_t stride) const noexcept
+    {
+        jassert (frameIndex >= 0 && frameIndex < frameCapacity);
+        return (size_t) frameIndex * stride;
+    }
+
+    struct AlignedDeleter
+    {
+        void operator() (float* p) const noexcept { ::operator delete[] (p, std::align_val_t { alignmentBytes }); }
+    };
+
+    std::unique_ptr<float[], AlignedDeleter> storage;
+
+    int frameCapacity = 0;
+    int windowSize = 0;
+    int orderCapacity = 0;
+    int numFrames = 0;
+
+    size_t windowStride = 0;
+    size_t orderStride = 0;
+
+    float* stackedFrames = nullptr;
+    float* synthesizedFrames = nullptr;
+    float* coefficients = nullptr;
+    float* reflections = nullptr;
+    float* powers = nullptr;
+    float* pitches = nullptr;
+    float* voicing = nullptr;
+    float* scratch = nullptr;
+
+    int realtimeDepth = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LPCFrameArena)
+};
@@ -1,16 +1,18 @@
 #include "LPCProcessor.h"
 #include <algorithm>
+#include <array>
 #include <cmath>
 
 LPCProcessor::LPCProcessor (int lpcOrder_, int windowSize_)
-    : lpcOrder (lpcOrder_),
+    : lpcOrder (juce::jmin (lpcOrder_, maxLpcOrder)),
       windowSize (windowSize_)
 {
-    hopSize = windowSize / 2;
+    updateHopSize();
 
     updateFFTObject();
     updateWindowFunction();
     updateInternalBuffers();
+    updateChannelBuffers();
 }
 
 LPCProcessor::~LPCProcessor() = default;
@@ -18,182 +20,113 @@ LPCProcessor::~LPCProcessor() = default;
 //==============================================================================
 void LPCProcessor::setWindowSize (int newSize)
 {
-<<<<<<< Updated upstream
     if (newSize <= 0 || newSize == windowSize)
-=======
+        return;
+
     windowSize = newSize;
-    new (&window) juce::dsp::WindowingFunction<float> (windowSize, juce::dsp::WindowingFunction<float>::hann); // Reconstruct in place
+    updateHopSize();
+
+    updateFFTObject();
+    updateWindowFunction();
+    updateInternalBuffers();
+    updateChannelBuffers();
 }
 
-void LPCProcessor::process(const juce::AudioBuffer<float>& inputBuffer, juce::AudioBuffer<float>& outputBuffer) const
+void LPCProcessor::setSynthesisMode (SynthesisMode newMode, int newInterpolatedHopSize)
 {
-    // this is the processors job, since we want this to be a parameter users can control.
-    //const juce::AudioBuffer<float> resampledBuffer = resampleBuffer(inputBuffer, targetSampleRate);
-
-    const int numSamples = inputBuffer.getNumSamples();
-    const int numChannels = inputBuffer.getNumChannels();
-
-    // process the input
-    for (int channel = 0; channel < numChannels; ++channel)
-    {
-        const float* input = inputBuffer.getReadPointer(channel);
-        float* output = outputBuffer.getWritePointer(channel);
+    const int newHop = newInterpolatedHopSize > 0 ? newInterpolatedHopSize : 0;
 
-        // Stack the input signal into overlapping windows
-        std::vector<std::vector<float>> stackedData;
-        stackOLA(input, numSamples, stackedData);
-
-        // Prepare buffers for LPC encoding
-        std::vector<std::vector<float>> lpcCoefficients;
-        std::vector<float> signalPower;
-        std::vector<float> pitchFrequencies;
-
-        encodeLPC(stackedData, lpcCoefficients, signalPower, pitchFrequencies);
+    if (newMode == synthesisMode && newHop == interpolatedHopSize)
+        return;
 
-        // Decode the signal
-        std::vector<std::vector<float>> synthesizedData;
-        decodeLPC(lpcCoefficients, signalPower, pitchFrequencies, stackedData.size(), synthesizedData);
+    synthesisMode = newMode;
+    interpolatedHopSize = newHop;
+    updateHopSize();
 
-        // Combine overlapping windows back into the output buffer
-        pressStack(synthesizedData, output, numSamples);
-    }
+    updateInternalBuffers();
+    updateChannelBuffers();
 }
 
-void LPCProcessor::encodeLPC(const std::vector<std::vector<float>>& stackedData,
-                              std::vector<std::vector<float>>& lpcCoefficients,
-                              std::vector<float>& signalPower,
-                              std::vector<float>& pitchFrequencies) const
+void LPCProcessor::updateHopSize()
 {
-    for (const auto& segment : stackedData)
-    {
-        std::vector<float> lpc(lpcOrder, 0.0f);
-        float power = 0.0f;
-
-        // Compute LPC coefficients using auto-correlation
-        computeLpc(segment.data(), segment.size(), lpcOrder, lpc, power);
-        lpcCoefficients.push_back(lpc);
-        signalPower.push_back(power);
-
-        // Perform pitch detection if enabled
-        if (pitchDetectionEnabled)
-        {
-            auto pitchFreq = static_cast<float>(detectPitch(segment));
-            pitchFrequencies.push_back(pitchFreq);
-        }
-        else
-        {
-            pitchFrequencies.push_back(0.0f); // Default to unvoiced
-        }
-    }
+    // Overlap-add needs 50% overlap for the Hann windows to sum to one; the
+    // interpolated mode can hop by anything, including more than a window
+    hopSize = synthesisMode == SynthesisMode::interpolated && interpolatedHopSize > 0
+                  ? interpolatedHopSize
+                  : windowSize / 2;
+
+    hopSize = juce::jmax (1, hopSize);
+    ringSize = juce::jmax (windowSize, hopSize);
 }
 
-void LPCProcessor::decodeLPC(const std::vector<std::vector<float>>& lpcCoefficients,
-                              const std::vector<float>& signalPower,
-                              const std::vector<float>& pitchFrequencies,
-                              const int numSegments,
-                              std::vector<std::vector<float>>& synthesizedData) const
+int LPCProcessor::getLatencySamples() const noexcept
 {
-    for (int i = 0; i < numSegments; ++i)
-    {
-        const auto& lpc = lpcCoefficients[i];
-        const float power = signalPower[i];
-        const float pitchFreq = pitchFrequencies[i];
+    // Interpolated: each hop is synthesized between the centres of two frames
+    return synthesisMode == SynthesisMode::interpolated ? windowSize / 2 + hopSize : windowSize;
+}
 
-        // Generate source signal
-        std::vector<float> source(windowSize, 0.0f);
-        if (pitchFreq > 0.0f) // Voiced
-        {
-            const int period = static_cast<int>(1.0f / pitchFreq * sampleRate);
-            for (size_t j = 0; j < source.size(); j += period)
-            {
-                source[j] = static_cast<float>(std::sqrt(period));
-            }
-        }
-        else // Unvoiced
-        {
-            std::ranges::generate (source, []() {
-                static std::mt19937 rng{std::random_device{}()};
-                static std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
-                return dist(rng);
-            });
-        }
+void LPCProcessor::setLpcOrder (int newOrder)
+{
+    if (newOrder <= 0 || newOrder == lpcOrder)
+        return;
 
-        // Filter source through LPC coefficients
-        std::vector<float> synthesizedSegment(windowSize, 0.0f);
-        for (size_t j = 0; j < source.size(); ++j)
-        {
-            synthesizedSegment[j] = source[j] * std::sqrt(power);
-            for (size_t k = 0; k < lpc.size(); ++k)
-            {
-                if (j > k)
-                {
-                    synthesizedSegment[j] -= lpc[k] * synthesizedSegment[j - k - 1];
-                }
-            }
-        }
-        synthesizedData.push_back(synthesizedSegment);
-    }
+    // The arena always holds maxLpcOrder coefficients per frame, nothing to reallocate
+    lpcOrder = juce::jmin (newOrder, maxLpcOrder);
 }
 
-void LPCProcessor::computeAutocorrelation(const float* input, const int numSamples, const int order, std::vector<float>& autocorrelation)
+//==============================================================================
+void LPCProcessor::prepare (double newSampleRate, int maximumBlockSize, int numChannels)
 {
-    const int fftSize = juce::nextPowerOfTwo(numSamples + order);
-    std::vector<float> fftBuffer(fftSize * 2, 0.0f);
+    maxBlockSize = juce::jmax (1, maximumBlockSize);
+    channels.resize ((size_t) juce::jmax (0, numChannels));
 
-    // Copy input into FFT buffer
-    std::copy_n(input, numSamples, fftBuffer.begin());
+    for (size_t ch = 0; ch < channels.size(); ++ch)
+    {
+        channels[ch].synthesisFilter.setStructure (synthesisStructure);
+        channels[ch].excitation.setSeed ((uint32_t) ch);
+    }
 
-    // Perform FFT
-    const juce::dsp::FFT fft(static_cast<int>(std::log2(fftSize)));
-    fft.performRealOnlyForwardTransform(fftBuffer.data());
+    maxSampleRate = newSampleRate;
+    updateInternalBuffers();
+    updateChannelBuffers();
+    setTargetSampleRate (newSampleRate);
+}
 
-    // Compute power spectrum (complex multiplication)
-    for (size_t i = 0; i < fftSize; ++i)
+void LPCProcessor::reset()
+{
+    for (auto& state : channels)
     {
-        const float real = fftBuffer[2 * i];
-        const float imag = fftBuffer[2 * i + 1];
-        fftBuffer[2 * i] = real * real + imag * imag; // Magnitude squared
-        fftBuffer[2 * i + 1] = 0.0f; // Zero imaginary part
+        std::fill (state.inputHistory.begin(), state.inputHistory.end(), 0.0f);
+        std::fill (state.outputAccumulator.begin(), state.outputAccumulator.end(), 0.0f);
     }
 
-    // Perform inverse FFT
-    fft.performRealOnlyInverseTransform(fftBuffer.data());
-
-    // Extract autocorrelation values
-    autocorrelation.resize(order + 1);
-    for (int i = 0; i <= order; ++i)
+    for (auto& state : channels)
     {
-        autocorrelation[i] = fftBuffer[i] / static_cast<float>(numSamples);
+        state.synthesisFilter.reset();
+        state.pitchTracker.clear();
+        state.excitation.reset();
+        state.hasPreviousFrame = false;
     }
+
+    ringPosition = 0;
+    samplesUntilNextHop = hopSize;
+    numFramesInChunk = 0;
 }
 
-void LPCProcessor::computeLpc(const float* input, const size_t numSamples, const int order,
-                              std::vector<float>& coefficients, float& power)
+void LPCProcessor::setTargetSampleRate (double newRate)
 {
-    if (numSamples <= order)
-    {
-        DBG("Insufficient samples for LPC computation!");
-        coefficients.assign(order, 0.0f);
-        power = 0.0f;
->>>>>>> Stashed changes
-        return;
-
-    windowSize = newSize;
-    hopSize = windowSize / 2;
+    sampleRate = newRate;
 
-    updateFFTObject();
-    updateWindowFunction();
-    updateInternalBuffers();
+    for (auto& state : channels)
+        state.pitchTracker.setSampleRate (sampleRate);
 }
 
-void LPCProcessor::setLpcOrder (int newOrder)
+void LPCProcessor::setSynthesisStructure (LPCSynthesisFilter::Structure newStructure)
 {
-    if (newOrder <= 0 || newOrder == lpcOrder)
-        return;
+    synthesisStructure = newStructure;
 
-    lpcOrder = newOrder;
-    // Realloc or clear buffers that depend on lpcOrder
-    updateInternalBuffers();
+    for (auto& state : channels)
+        state.synthesisFilter.setStructure (synthesisStructure);
 }
 
 //==============================================================================
@@ -201,20 +134,37 @@ void LPCProcessor::process (const juce::AudioBuffer<float>& inputBuffer,
     juce::AudioBuffer<float>& outputBuffer)
 {
     jassert (inputBuffer.getNumChannels() == outputBuffer.getNumChannels());
-    const int numChannels = inputBuffer.getNumChannels();
+    jassert (inputBuffer.getNumSamples() <= outputBuffer.getNumSamples());
+    jassert (inputBuffer.getNumChannels() <= (int) channels.size()); // call prepare() first!
+
+    const int numChannels = juce::jmin (inputBuffer.getNumChannels(), (int) channels.size());
     const int numSamples = inputBuffer.getNumSamples();
 
-    // Clear output first
-    outputBuffer.clear();
+    if (numChannels == 0 || hopSize <= 0)
+    {
+        outputBuffer.clear();
+        return;
+    }
+
+    // Everything below runs on preallocated storage: growing the arena here is a bug
+    const LPCFrameArena::ScopedRealtimeLock realtimeLock (arena);
 
-    // Process each channel independently:
-    for (int ch = 0; ch < numChannels; ++ch)
+    // Work through the block in chunks that complete at most maxFramesPerChunk hops,
+    // so an arbitrarily large (offline) block never outgrows the frame storage.
+    for (int position = 0; position < numSamples;)
     {
-        const float* inPtr = inputBuffer.getReadPointer (ch);
-        float* outPtr = outputBuffer.getWritePointer (ch);
+        const int chunkSize = juce::jmin (numSamples - position,
+            samplesUntilNextHop + (maxFramesPerChunk - 1) * hopSize);
 
-        // 1) stackOLA: partition + window the input
-        stackOLA (inPtr, (size_t) numSamples);
+        numFramesInChunk = 0;
+        for (int offset = samplesUntilNextHop; offset <= chunkSize; offset += hopSize)
+            frameOffsets[(size_t) numFramesInChunk++] = offset;
+
+        // 1) stackOLA: every channel's input is consumed before any output is written,
+        //    which is what makes in-place processing safe
+        arena.setNumFrames (numFramesInChunk * numChannels);
+        for (int ch = 0; ch < numChannels; ++ch)
+            stackOLA (channels[(size_t) ch], ch, inputBuffer.getReadPointer (ch, position), chunkSize);
 
         // 2) encodeLPC: compute LPC + power (+ pitch if enabled)
         encodeLPC();
@@ -222,322 +172,366 @@ void LPCProcessor::process (const juce::AudioBuffer<float>& inputBuffer,
         // 3) decodeLPC: create excitation & filter with LPC
         decodeLPC();
 
-        // 4) pressStack: overlap-add the frames to outPtr
-        pressStack (outPtr, numSamples);
+        // 4) pressStack: overlap-add the frames and read out finished samples
+        for (int ch = 0; ch < numChannels; ++ch)
+            pressStack (channels[(size_t) ch], ch, outputBuffer.getWritePointer (ch, position), chunkSize);
+
+        ringPosition = (ringPosition + chunkSize) % ringSize;
+        samplesUntilNextHop = numFramesInChunk > 0
+                                  ? frameOffsets[(size_t) numFramesInChunk - 1] + hopSize - chunkSize
+                                  : samplesUntilNextHop - chunkSize;
+        position += chunkSize;
     }
+
+    for (int ch = numChannels; ch < outputBuffer.getNumChannels(); ++ch)
+        outputBuffer.clear (ch, 0, numSamples);
 }
 
 //==============================================================================
-void LPCProcessor::stackOLA (const float* input, size_t numSamples)
+void LPCProcessor::stackOLA (ChannelState& state, int channelIndex, const float* input, int numSamples)
 {
-    stackedData.clear();
-
-    // If there's not enough data for even 1 window, just bail
-    if (windowSize <= 0 || hopSize <= 0 || numSamples < (size_t) windowSize)
-        return;
+    const int firstFrame = channelIndex * numFramesInChunk;
+    auto& history = state.inputHistory;
+    int writeIdx = ringPosition;
+    int consumed = 0;
 
-    const int numWindows = ((int) numSamples - windowSize) / hopSize + 1;
-    stackedData.reserve ((size_t) numWindows);
+    // Low pitches at high rates need longer frames than the window, so the tracker
+    // keeps its own history and estimates as each hop completes
+    const bool tracksOwnFrames = pitchDetectionEnabled && state.pitchTracker.needsOwnFrames();
 
-    for (int i = 0; i < numWindows; ++i)
+    for (int f = 0; f <= numFramesInChunk; ++f)
     {
-        std::vector<float> segment ((size_t) windowSize, 0.0f);
-        const size_t startIdx = i * (size_t) hopSize;
+        const int segmentEnd = f < numFramesInChunk ? frameOffsets[(size_t) f] : numSamples;
 
-        // Copy samples from input into segment
-        std::copy_n (input + startIdx, (size_t) windowSize, segment.begin());
+        if (tracksOwnFrames)
+            state.pitchTracker.pushSamples (input + consumed, segmentEnd - consumed);
+
+        // Copy samples from input into the history ring
+        while (consumed < segmentEnd)
+        {
+            const int run = juce::jmin (segmentEnd - consumed, ringSize - writeIdx);
+            std::copy_n (input + consumed, run, history.begin() + writeIdx);
+            consumed += run;
+            writeIdx = (writeIdx + run) % ringSize;
+        }
+
+        if (f == numFramesInChunk)
+            break;
+
+        // A hop just completed: unroll the last windowSize samples (oldest first) into the frame's arena row
+        float* segment = arena.getFrame (firstFrame + f);
+        const int start = (writeIdx - windowSize + ringSize) % ringSize;
+        const int tail = juce::jmin (windowSize, ringSize - start);
+        std::copy_n (history.begin() + start, tail, segment);
+        std::copy_n (history.begin(), windowSize - tail, segment + tail);
 
         // Multiply by our Hann window
-        for (int n = 0; n < windowSize; ++n)
-            segment[(size_t) n] *= hannWindow[(size_t) n];
+        juce::FloatVectorOperations::multiply (segment, hannWindow.data(), windowSize);
 
-        stackedData.push_back (std::move (segment));
+        if (tracksOwnFrames)
+        {
+            const auto estimate = state.pitchTracker.processHistory();
+            arena.getPitches()[firstFrame + f] = estimate.frequency;
+            arena.getVoicing()[firstFrame + f] = estimate.confidence;
+        }
     }
 }
 
 //==============================================================================
-void LPCProcessor::pressStack (float* output, int outputSize)
+void LPCProcessor::pressStack (ChannelState& state, int channelIndex, float* output, int numSamples)
 {
-    if (stackedData.size() != synthesizedData.size())
-        return; // mismatch
+    auto& accumulator = state.outputAccumulator;
+    const int firstFrame = channelIndex * numFramesInChunk;
+    int readIdx = ringPosition;
+    int written = 0;
 
-    for (size_t i = 0; i < synthesizedData.size(); ++i)
+    for (int f = 0; f <= numFramesInChunk; ++f)
     {
-        const auto& frame = synthesizedData[i];
-        const size_t startIdx = i * (size_t) hopSize;
+        const int segmentEnd = f < numFramesInChunk ? frameOffsets[(size_t) f] : numSamples;
 
-        for (size_t n = 0; n < (size_t) windowSize; ++n)
+        // Finished samples leave the ring, freeing their slot for the next frame's tail
+        while (written < segmentEnd)
         {
-            if (startIdx + n < (size_t) outputSize)
-                output[startIdx + n] += frame[n];
+            const int run = juce::jmin (segmentEnd - written, ringSize - readIdx);
+            std::copy_n (accumulator.begin() + readIdx, run, output + written);
+            std::fill_n (accumulator.begin() + readIdx, run, 0.0f);
+            written += run;
+            readIdx = (readIdx + run) % ringSize;
         }
+
+        if (f == numFramesInChunk)
+            break;
+
+        const float* frame = arena.getSynthesized (firstFrame + f);
+
+        // Interpolated hops are contiguous: each one is simply the next hopSize samples
+        if (synthesisMode == SynthesisMode::interpolated)
+        {
+            const int first = juce::jmin (hopSize, ringSize - readIdx);
+            juce::FloatVectorOperations::add (accumulator.data() + readIdx, frame, first);
+            juce::FloatVectorOperations::add (accumulator.data(), frame + first, hopSize - first);
+            continue;
+        }
+
+        // Overlap-add the synthesized frame, starting with the next sample to be read.
+        // The Hann synthesis window makes the 50% overlapped frames sum to unity.
+        const int tail = juce::jmin (windowSize, ringSize - readIdx);
+        juce::FloatVectorOperations::addWithMultiply (accumulator.data() + readIdx, frame, hannWindow.data(), tail);
+        juce::FloatVectorOperations::addWithMultiply (accumulator.data(), frame + tail, hannWindow.data() + tail, windowSize - tail);
     }
 }
 
 //==============================================================================
 void LPCProcessor::encodeLPC()
 {
-    lpcCoefficients.clear();
-    signalPowers.clear();
-    pitchFrequencies.clear();
+    // Frames are stored channel after channel, so with two channels frame f of the
+    // left channel pairs up with frame f + numFramesInChunk of the right one
+    const bool packStereo = stereoPackingEnabled
+                            && numFramesInChunk > 0
+                            && arena.getNumFrames() == 2 * numFramesInChunk;
 
-    lpcCoefficients.reserve (stackedData.size());
-    signalPowers.reserve (stackedData.size());
-    pitchFrequencies.reserve (stackedData.size());
-
-    for (auto& frame : stackedData)
+    if (packStereo)
     {
-        std::vector<float> lpc ((size_t) lpcOrder, 0.0f);
-        float power = 0.0f;
+        for (int f = 0; f < numFramesInChunk; ++f)
+            encodeStereoPair (f, f + numFramesInChunk);
 
-        computeLpc (frame.data(), frame.size(), lpc, power);
+        return;
+    }
 
-        lpcCoefficients.push_back (std::move (lpc));
-        signalPowers.push_back (power);
+    for (int i = 0; i < arena.getNumFrames(); ++i)
+        encodeFrame (i);
+}
 
-        if (pitchDetectionEnabled)
-        {
-            const double pitchHz = detectPitch (frame.data(), frame.size());
-            pitchFrequencies.push_back ((float) pitchHz);
-        }
-        else
-        {
-            pitchFrequencies.push_back (0.0f); // unvoiced
-        }
-    }
+void LPCProcessor::encodeFrame (int frameIndex)
+{
+    const float* frame = arena.getFrame (frameIndex);
+
+    // One autocorrelation serves both the LPC recursion and the pitch tracker
+    float* lags = lagBuffer.data();
+    computeAutocorrelation (frame, windowSize, getAnalysisMaxLag(), lags);
+
+    computeLpc (lags, (size_t) windowSize, arena.getCoefficients (frameIndex), arena.getReflections (frameIndex), arena.getPowers()[frameIndex]);
+    trackPitch (frameIndex, lags);
 }
 
-//==============================================================================
-void LPCProcessor::decodeLPC()
+void LPCProcessor::encodeStereoPair (int leftIndex, int rightIndex)
 {
-    synthesizedData.clear();
-    synthesizedData.reserve (stackedData.size());
+    const float* left = arena.getFrame (leftIndex);
+    const float* right = arena.getFrame (rightIndex);
+    const int maxLag = getAnalysisMaxLag();
 
-    for (size_t i = 0; i < stackedData.size(); ++i)
-    {
-        const auto& coefs = lpcCoefficients[i];
-        const float power = signalPowers[i];
-        const float pitch = pitchFrequencies[i];
+    // Lags for both channels, from one packed transform pair when the FFT method is the cheaper one
+    float* lagsLeft = lagBuffer.data();
+    float* lagsRight = lagsLeft + (windowSize + 1);
 
-        // Create the excitation signal
-        std::vector<float> source ((size_t) windowSize, 0.0f);
+    if (autocorrelator.usesFFT (windowSize, maxLag))
+    {
+        stereoFFT.computeAutocorrelations (left, right, windowSize, maxLag, lagsLeft, lagsRight);
+    }
+    else
+    {
+        computeAutocorrelation (left, windowSize, maxLag, lagsLeft);
+        computeAutocorrelation (right, windowSize, maxLag, lagsRight);
+    }
 
-        if (pitch > 0.0f)
-        {
-            // Voiced -> impulse train
-            int period = (sampleRate > 0.0 && pitch > 1.0)
-                             ? (int) std::floor (sampleRate / pitch + 0.5)
-                             : windowSize; // fallback
-
-            for (int idx = 0; idx < windowSize; idx += period)
-            {
-                if (idx < windowSize)
-                    source[(size_t) idx] = std::sqrt ((float) period);
-            }
-        }
-        else
-        {
-            // Unvoiced -> white noise
-            for (auto& x : source)
-                x = dist (rng);
-        }
+    float* powers = arena.getPowers();
+    computeLpc (lagsLeft, (size_t) windowSize, arena.getCoefficients (leftIndex), arena.getReflections (leftIndex), powers[leftIndex]);
+    computeLpc (lagsRight, (size_t) windowSize, arena.getCoefficients (rightIndex), arena.getReflections (rightIndex), powers[rightIndex]);
 
-        // AR filter: out[n] = gain * in[n] - sum(a[k]*out[n-(k+1)])
-        std::vector<float> synth ((size_t) windowSize, 0.0f);
-        float gain = std::sqrt (std::max (power, 1e-8f));
+    trackPitch (leftIndex, lagsLeft);
+    trackPitch (rightIndex, lagsRight);
+}
 
-        for (size_t n = 0; n < (size_t) windowSize; ++n)
-        {
-            float y = source[n] * gain;
-
-            for (int k = 0; k < lpcOrder; ++k)
-            {
-                if (n > (size_t) k)
-                    y -= coefs[(size_t) k] * synth[n - (k + 1)];
-            }
-            synth[n] = y;
-        }
+int LPCProcessor::getAnalysisMaxLag() const noexcept
+{
+    if (! pitchDetectionEnabled || channels.empty() || channels.front().pitchTracker.needsOwnFrames())
+        return lpcOrder;
 
-        synthesizedData.push_back (std::move (synth));
-    }
+    // Every channel's tracker has the same lag range
+    return juce::jmax (lpcOrder, channels.front().pitchTracker.getMaxLag());
 }
 
-//==============================================================================
-void LPCProcessor::computeLpc (const float* windowedData, size_t length, std::vector<float>& lpcOut, float& powerOut)
+void LPCProcessor::trackPitch (int frameIndex, const float* autocorrelation)
 {
-    if (length < (size_t) (lpcOrder + 1))
+    auto& tracker = channels[(size_t) (frameIndex / numFramesInChunk)].pitchTracker;
+
+    if (! pitchDetectionEnabled)
     {
-        std::fill (lpcOut.begin(), lpcOut.end(), 0.0f);
-        powerOut = 0.0f;
+        arena.getPitches()[frameIndex] = 0.0f; // unvoiced
+        arena.getVoicing()[frameIndex] = 0.0f;
+        tracker.reset();
         return;
     }
 
-    // Autocorrelation for lags 0..lpcOrder
-    std::vector<float> autocorr ((size_t) lpcOrder + 1, 0.0f);
-    computeAutocorrelation (windowedData, (int) length, lpcOrder, autocorr.data());
+    // Already estimated from the tracker's own frames in stackOLA
+    if (tracker.needsOwnFrames())
+        return;
 
-    // The "energy" (R[0]) can be our initial power estimate
-    powerOut = std::max (autocorr[0], 1e-8f);
+    const auto estimate = tracker.process (arena.getFrame (frameIndex), windowSize, autocorrelation);
+    arena.getPitches()[frameIndex] = estimate.frequency;
+    arena.getVoicing()[frameIndex] = estimate.confidence;
+}
 
-    // Levinson-Durbin
-    std::fill (lpcOut.begin(), lpcOut.end(), 0.0f);
-    std::vector<float> error ((size_t) lpcOrder + 1, powerOut);
+//==============================================================================
+void LPCProcessor::decodeLPC()
+{
+    const float* powers = arena.getPowers();
+    const float* pitches = arena.getPitches();
+    const float* voicing = arena.getVoicing();
+    float* source = arena.getScratch();
 
-    for (int i = 1; i <= lpcOrder; ++i)
+    for (int i = 0; i < arena.getNumFrames(); ++i)
     {
-        float acc = 0.0f;
-        for (int j = 1; j < i; ++j)
+        const float* coefs = arena.getCoefficients (i);
+        const float power = powers[i];
+        auto& state = channels[(size_t) (i / numFramesInChunk)];
+        const float gain = std::sqrt (std::max (power, 1e-8f));
+
+        if (synthesisMode == SynthesisMode::interpolated)
         {
-            acc += lpcOut[(size_t) (j - 1)] * autocorr[(size_t) (i - j)];
+            state.excitation.generateFrame (source, hopSize, hopSize, sampleRate, pitches[i], voicing[i]);
+            decodeInterpolated (state, i, source, gain);
+            continue;
         }
 
-        float ref = 0.0f;
-        const float denom = error[(size_t) i - 1];
-        if (std::fabs (denom) > 1e-12f)
-            ref = (autocorr[(size_t) i] - acc) / denom;
-
-        // clamp reflection
-        if (ref > 0.999f)
-            ref = 0.999f;
-        else if (ref < -0.999f)
-            ref = -0.999f;
+        // Excitation: band-limited pulses and/or noise, mixed by the voicing confidence.
+        // Like the filter, the generator only commits the first hop of the frame.
+        state.excitation.generateFrame (source, windowSize, hopSize, sampleRate, pitches[i], voicing[i]);
 
-        // update lpcOut
-        auto oldCoefs = lpcOut; // copy
-        for (int k = 0; k < (i - 1) / 2; ++k)
-        {
-            float c1 = oldCoefs[(size_t) k];
-            float c2 = oldCoefs[(size_t) (i - k - 2)];
-            lpcOut[(size_t) k] = c1 + ref * c2;
-            lpcOut[(size_t) (i - k - 2)] = c2 + ref * c1;
-        }
-        lpcOut[(size_t) i - 1] = ref;
+        // AR filter: out[n] = gain * in[n] - sum(a[k]*out[n-(k+1)])
+        // The channel's filter carries its state from one hop to the next, so the frame
+        // starts where the previous frame's first hop ended instead of from silence.
+        auto& filter = state.synthesisFilter;
 
-        // update error
-        error[(size_t) i] = error[(size_t) i - 1] * (1.0f - ref * ref);
-        if (error[(size_t) i] < 1e-12f)
-            error[(size_t) i] = 1e-12f; // avoid blow-ups
+        // The lattice runs on the reflection coefficients straight from the recursion
+        if (synthesisStructure == LPCSynthesisFilter::Structure::lattice)
+            filter.setReflectionCoefficients (arena.getReflections (i), lpcOrder);
+        else
+            filter.setCoefficients (coefs, lpcOrder);
+        filter.processFrame (source, arena.getSynthesized (i), windowSize, hopSize, gain);
     }
 }
 
-//==============================================================================
-void LPCProcessor::computeAutocorrelation (const float* data, int length, int order, float* dest)
+void LPCProcessor::decodeInterpolated (ChannelState& state, int frameIndex, const float* source, float gain)
 {
-    // 1) Zero out the fftBuffer
-    std::fill (fftBuffer.begin(), fftBuffer.end(), 0.0f);
+    // The hop runs from the previous frame's centre to this one's, so the model
+    // glides from the previous set to this frame's across the subframes. Log-area
+    // ratios keep every intermediate filter stable, unlike blending a[k] directly.
+    std::array<float, maxLpcOrder> logArea {}, blended {}, reflection {};
+    LPCSynthesisFilter::reflectionToLogArea (arena.getReflections (frameIndex), lpcOrder, logArea.data());
 
-    // 2) Copy 'length' samples into the real part of fftBuffer
-    for (int i = 0; i < length; ++i)
-        fftBuffer[(size_t) i] = data[i];
+    if (! state.hasPreviousFrame)
+    {
+        state.previousLogArea = logArea;
+        state.previousGain = gain;
+        state.hasPreviousFrame = true;
+    }
 
-    // 3) Forward FFT
-    fft->performRealOnlyForwardTransform (fftBuffer.data());
+    auto& filter = state.synthesisFilter;
+    float* output = arena.getSynthesized (frameIndex);
+    const int numSubframes = juce::jmin (interpolationSubframes, hopSize);
 
-    // 4) Compute power spectrum => real part = magnitude^2, imag part = 0
-    for (int i = 0; i < fftSize; ++i)
+    for (int j = 0; j < numSubframes; ++j)
     {
-        float re = fftBuffer[2 * (size_t) i];
-        float im = fftBuffer[2 * (size_t) i + 1];
-        float mag = re * re + im * im;
+        const int start = j * hopSize / numSubframes;
+        const int end = (j + 1) * hopSize / numSubframes;
 
-        fftBuffer[2 * (size_t) i] = mag;
-        fftBuffer[2 * (size_t) i + 1] = 0.0f;
-    }
+        // Each subframe uses the model at its end, reaching this frame's exactly
+        const float t = (float) (j + 1) / (float) numSubframes;
 
-    // 5) Inverse FFT => time-domain autocorrelation in fftBuffer
-    fft->performRealOnlyInverseTransform (fftBuffer.data());
+        for (int k = 0; k < lpcOrder; ++k)
+            blended[(size_t) k] = state.previousLogArea[(size_t) k] + t * (logArea[(size_t) k] - state.previousLogArea[(size_t) k]);
 
-    // 6) Normalize by fftSize (NOT by 'length'), then copy lags [0..order] to 'dest'
-    for (int k = 0; k <= order; ++k)
-        dest[k] = fftBuffer[(size_t) k] / (float) fftSize;
-}
+        LPCSynthesisFilter::logAreaToReflection (blended.data(), lpcOrder, reflection.data());
+        filter.setReflectionCoefficients (reflection.data(), lpcOrder);
+        filter.process (source + start, output + start, end - start, state.previousGain + t * (gain - state.previousGain));
+    }
 
+    state.previousLogArea = logArea;
+    state.previousGain = gain;
+}
 
 //==============================================================================
-double LPCProcessor::detectPitch (const float* windowedData, size_t length)
+void LPCProcessor::computeLpc (const float* autocorrelation, size_t length, float* lpcOut, float* reflectionOut, float& powerOut)
 {
-    if (sampleRate <= 0.0 || length == 0)
-        return 0.0;
+    if (length < (size_t) (lpcOrder + 1))
+    {
+        std::fill_n (lpcOut, lpcOrder, 0.0f);
+        std::fill_n (reflectionOut, lpcOrder, 0.0f);
+        powerOut = 0.0f;
+        return;
+    }
 
-    std::vector<float> mags;
-    performFFT (windowedData, length, mags);
-    if (mags.empty())
-        return 0.0;
+    // White-noise correction: raising R[0] by a -40 dB noise floor keeps the normal
+    // equations well conditioned, so (nearly) pure tones can't drive the model onto
+    // the unit circle and its gain towards infinity
+    std::array<float, maxLpcOrder + 1> conditioned {};
+    std::copy_n (autocorrelation, lpcOrder + 1, conditioned.begin());
+    conditioned[0] *= 1.0f + whiteNoiseCorrection;
 
-    // largest bin
-    auto it = std::max_element (mags.begin(), mags.end());
-    int idx = (int) std::distance (mags.begin(), it);
+    // Levinson-Durbin, specialised for the current order
+    const float residual = LevinsonDurbin::solve (conditioned.data(), lpcOrder, lpcOut, reflectionOut, doublePrecisionAnalysis);
 
-    // freq = (Fs * binIndex) / (N * 2)  since we only have half the bins in mags
-    double freq = (sampleRate * idx) / (mags.size() * 2.0);
-    return freq;
+    // The synthesis filter's excitation has unit power, so scale it by the mean
+    // residual (prediction error) power rather than the frame energy R[0]
+    powerOut = residual / (float) length;
 }
 
 //==============================================================================
-void LPCProcessor::performFFT (const float* input, size_t length, std::vector<float>& magnitudes)
+void LPCProcessor::computeAutocorrelation (const float* data, int length, int order, float* dest)
 {
-    // zero fftBuffer
-    std::fill (fftBuffer.begin(), fftBuffer.end(), 0.0f);
-
-    // copy input
-    jassert (length <= (size_t) fftSize); // must not exceed our allocated size
-    for (size_t i = 0; i < length; ++i)
-        fftBuffer[i] = input[i];
-
-    // forward transform
-    fft->performRealOnlyForwardTransform (fftBuffer.data());
-
-    // half-spectrum magnitude
-    size_t halfSize = length / 2;
-    magnitudes.resize (halfSize);
-
-    for (size_t i = 0; i < halfSize; ++i)
-    {
-        float re = fftBuffer[2 * i];
-        float im = fftBuffer[2 * i + 1];
-        magnitudes[i] = std::sqrt (re * re + im * im);
-    }
+    // Direct lag kernel or FFT, whichever the cost model expects to be cheaper
+    autocorrelator.compute (data, length, order, dest);
 }
 
 //==============================================================================
 void LPCProcessor::updateInternalBuffers()
 {
-    // Clear vectors and preallocate a typical capacity
-    stackedData.clear();
-    lpcCoefficients.clear();
-    signalPowers.clear();
-    pitchFrequencies.clear();
-    synthesizedData.clear();
-
-    stackedData.reserve (128);
-    lpcCoefficients.reserve (128);
-    signalPowers.reserve (128);
-    pitchFrequencies.reserve (128);
-    synthesizedData.reserve (128);
-
-    // Also re-zero FFT buffer
-    fftBuffer.assign ((size_t) fftSize * 2, 0.0f);
+    // One chunk never completes more hops than a full host block can hold (plus the
+    // one that was already pending), for every channel
+    maxFramesPerChunk = hopSize > 0 ? maxBlockSize / hopSize + 1 : 1;
+    frameOffsets.assign ((size_t) maxFramesPerChunk, 0);
+
+    // Coefficient rows are sized for the largest order, so setLpcOrder never reallocates
+    // (rows hold a window, or a whole hop when interpolating with hops longer than that)
+    arena.allocate (maxFramesPerChunk * juce::jmax (1, (int) channels.size()), ringSize, maxLpcOrder);
+}
+
+void LPCProcessor::updateChannelBuffers()
+{
+    for (auto& state : channels)
+    {
+        state.inputHistory.assign ((size_t) ringSize, 0.0f);
+        state.outputAccumulator.assign ((size_t) ringSize, 0.0f);
+
+        state.pitchTracker.prepare (windowSize, maxSampleRate);
+        state.pitchTracker.setSampleRate (sampleRate);
+    }
+
+    reset();
 }
 
 void LPCProcessor::updateFFTObject()
 {
-    // We need an FFT size that can handle 2*windowSize
-    fftSize = juce::nextPowerOfTwo (2 * windowSize);
+    // Both transforms zero-pad to 2 * windowSize, so every lag is free of wrap-around
+    autocorrelator.prepare (windowSize);
+    stereoFFT.prepare (windowSize);
 
-    fft = std::make_unique<juce::dsp::FFT> ((int) std::log2 ((double) fftSize));
-    fftBuffer.assign ((size_t) fftSize * 2, 0.0f);
+    // Room for every lag of two channels (pitch tracking needs up to windowSize / 2)
+    lagBuffer.assign ((size_t) (windowSize + 1) * 2, 0.0f);
 }
 
 void LPCProcessor::updateWindowFunction()
 {
     hannWindow.resize ((size_t) windowSize, 1.0f);
 
-    // Fill with a Hann window: w[n] = 0.5 * (1 - cos(2*pi*n/(N-1)))
+    // Fill with a periodic Hann window: w[n] = 0.5 * (1 - cos(2*pi*n/N))
+    // (periodic rather than symmetric so that frames one hop apart sum to exactly 1)
     if (windowSize > 1)
     {
         for (int n = 0; n < windowSize; ++n)
         {
-            float ratio = (float) n / (float) (windowSize - 1);
+            float ratio = (float) n / (float) windowSize;
             float w = 0.5f * (1.0f - std::cos (2.0f * juce::MathConstants<float>::pi * ratio));
             hannWindow[(size_t) n] = w;
         }
@@ -1,26 +1,67 @@
 #pragma once
 
+#include "Autocorrelator.h"
+#include "ExcitationGenerator.h"
+#include "LPCFrameArena.h"
+#include "LPCSynthesisFilter.h"
+#include "LevinsonDurbin.h"
+#include "PackedStereoFFT.h"
+#include "PitchTracker.h"
+
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_dsp/juce_dsp.h>
 
+#include <array>
 #include <memory>
-#include <random>
 #include <vector>
 
 /**
     A simplified LPC-based audio processor:
-    - Overlap-add framing
-    - Compute LPC via autocorrelation + Levinson-Durbin
-    - Optional naive pitch detection
-    - Synthesize frames with impulse train or noise
+    - Streaming overlap-add framing (fixed hops, independent of host block size)
+    - Compute LPC via autocorrelation + Levinson-Durbin (stereo pairs share packed FFTs)
+    - Optional pitch tracking (McLeod NSDF on the same autocorrelation)
+    - Synthesize frames from band-limited pulses and/or noise (see ExcitationGenerator)
+
+    Input samples are collected in a per-channel history ring and a new frame is
+    analysed every hopSize samples, however the host slices the audio. Synthesized
+    frames are overlap-added into a per-channel output ring, so the processor has
+    a constant latency of exactly one window.
+
+    In the interpolated synthesis mode the hop is free (it may exceed the window)
+    and each hop is synthesized once, from the previous frame's centre to the
+    current one, with the model interpolated per subframe in the log-area-ratio
+    domain. Larger hops then cost far less analysis without zipper noise.
 */
 class LPCProcessor
 {
 public:
+    /** Highest model order the LPC_ORDER parameter can ask for. */
+    static constexpr int maxLpcOrder = LevinsonDurbin::maxOrder;
+
+    /** Relative noise floor added to R[0] before the recursion (-40 dB). */
+    static constexpr float whiteNoiseCorrection = 1.0e-4f;
+
+    enum class SynthesisMode
+    {
+        overlapAdd, ///< Hann-windowed frames at 50% overlap, one model per frame.
+        interpolated ///< contiguous hops, model interpolated across subframes.
+    };
+
+    /** Default number of coefficient updates per hop in the interpolated mode. */
+    static constexpr int defaultInterpolationSubframes = 8;
+
     LPCProcessor (int lpcOrder, int windowSize);
     ~LPCProcessor();
 
     //==========================================================================
+    /** Allocates the streaming state for the given channel count and largest
+        expected block. Must be called before process(), off the audio thread.
+    */
+    void prepare (double newSampleRate, int maximumBlockSize, int numChannels);
+
+    /** Clears the input history and pending overlap-add tails. */
+    void reset();
+
     /** Adjusts the analysis/synthesis window size. */
     void setWindowSize (int newSize);
 
@@ -30,63 +71,113 @@ public:
     /** Enables or disables pitch detection (voiced/unvoiced). */
     void setPitchDetectionEnabled (bool shouldEnable) { pitchDetectionEnabled = shouldEnable; }
 
+    /** Chooses the direct-form or lattice synthesis filter (clears the filter state). */
+    void setSynthesisStructure (LPCSynthesisFilter::Structure newStructure);
+
+    /** Runs the Levinson-Durbin recursion with double accumulators (steadier at high orders). */
+    void setDoublePrecisionAnalysis (bool shouldUseDouble) noexcept { doublePrecisionAnalysis = shouldUseDouble; }
+
+    /** Analyses stereo input as packed channel pairs, one complex FFT per pair (on by default). */
+    void setStereoPackingEnabled (bool shouldPack) noexcept { stereoPackingEnabled = shouldPack; }
+
+    /** Forces the autocorrelation method (see Autocorrelator); automatic by default. */
+    void setAutocorrelationMethod (Autocorrelator::Method newMethod) noexcept { autocorrelator.setMethod (newMethod); }
+
+    /** Chooses overlap-add or interpolated synthesis. hopSize is used by the
+        interpolated mode only (0 = half a window); overlap-add always hops by half
+        a window. Reallocates, so call it off the audio thread.
+    */
+    void setSynthesisMode (SynthesisMode newMode, int interpolatedHopSize = 0);
+
+    /** Number of coefficient updates per hop in the interpolated mode. */
+    void setInterpolationSubframes (int numSubframes) noexcept { interpolationSubframes = juce::jmax (1, numSubframes); }
+
     /** Sets the sample rate used for pitch detection & period calculations. */
-    void setTargetSampleRate (double newRate) { sampleRate = newRate; }
+    void setTargetSampleRate (double newRate);
+
+    /** Latency in samples: one window for overlap-add, half a window plus one hop
+        when interpolating.
+    */
+    int getLatencySamples() const noexcept;
+
+    int getHopSize() const noexcept { return hopSize; }
 
     //==========================================================================
-    /** Main processing function: 
-        1) Overlap-add frames from input
+    /** Main processing function:
+        1) Push input into the history ring, stacking a frame every hop
         2) Compute LPC & pitch
         3) Re-synthesize
-        4) Overlap-add to output
+        4) Overlap-add into the output ring and read out the finished samples
+
+        Any block size is accepted, and inputBuffer may be the same buffer as
+        outputBuffer.
     */
     void process (const juce::AudioBuffer<float>& inputBuffer,
         juce::AudioBuffer<float>& outputBuffer);
 
 private:
+    //==========================================================================
+    /** Streaming state kept per channel between process() calls. */
+    struct ChannelState
+    {
+        std::vector<float> inputHistory; ///< last windowSize input samples (ring).
+        std::vector<float> outputAccumulator; ///< overlap-add sums waiting to be output (ring).
+        LPCSynthesisFilter synthesisFilter; ///< AR filter memory carried from hop to hop.
+        PitchTracker pitchTracker; ///< remembers the previous period for hop-to-hop tracking.
+        ExcitationGenerator excitation; ///< pulse phase and noise position carried from hop to hop.
+
+        // Interpolated mode: where the previous hop's model ended
+        std::array<float, maxLpcOrder> previousLogArea {};
+        float previousGain = 0.0f;
+        bool hasPreviousFrame = false;
+    };
+
     //==========================================================================
     // Internal helpers:
 
-    /** Break input into overlapping windowed segments. */
-    void stackOLA (const float* input, size_t numSamples);
+    /** Push a chunk of input into the history ring, stacking a windowed frame at each hop. */
+    void stackOLA (ChannelState& state, int channelIndex, const float* input, int numSamples);
 
-    /** Overlap-add synthesized frames into output. */
-    void pressStack (float* output, int outputSize);
+    /** Read a chunk out of the output ring, overlap-adding each synthesized frame at its hop. */
+    void pressStack (ChannelState& state, int channelIndex, float* output, int numSamples);
 
     /** For each stacked frame, compute LPC + power (+ pitch if enabled). */
     void encodeLPC();
 
-<<<<<<< Updated upstream
+    /** encodeLPC() for a single frame, with its own transforms. */
+    void encodeFrame (int frameIndex);
+
+    /** encodeLPC() for the same hop of the left and right channel, sharing packed transforms. */
+    void encodeStereoPair (int leftIndex, int rightIndex);
+
     /** For each frame, create an excitation signal & AR-filter it to get final audio. */
     void decodeLPC();
 
+    /** decodeLPC() for the interpolated mode: one hop per frame, subframe by subframe. */
+    void decodeInterpolated (ChannelState& state, int frameIndex, const float* source, float gain);
+
+    /** Derives hopSize and ringSize from the window size and synthesis mode. */
+    void updateHopSize();
+
     /** Autocorrelation -> reflection coefficients -> LPC (Levinson-Durbin). */
-    void computeLpc (const float* windowedData, size_t length, std::vector<float>& lpcOut, float& powerOut);
-=======
-    void decodeLPC (const std::vector<std::vector<float>>& lpcCoefficients,
-        const std::vector<float>& signalPower,
-        const std::vector<float>& pitchFrequencies,
-        int numSegments,
-        std::vector<std::vector<float>>& synthesizedData) const;
-    static void computeAutocorrelation (const float* input, int numSamples, int order, std::vector<float>& autocorrelation);
-
-    static void computeLpc(const float* input, size_t numSamples, int order,
-                    std::vector<float>& coefficients, float& power);
->>>>>>> Stashed changes
-
-    /** Compute the autocorrelation using an FFT-based method (faster for big windowSize). */
+    void computeLpc (const float* autocorrelation, size_t length, float* lpcOut, float* reflectionOut, float& powerOut);
+
+    /** Compute the autocorrelation for lags 0..order (direct or FFT, see Autocorrelator). */
     void computeAutocorrelation (const float* data, int length, int order, float* dest);
 
-    /** Naive pitch detection: largest bin in an FFT. */
-    double detectPitch (const float* windowedData, size_t length);
+    /** Highest autocorrelation lag the current settings need (LPC order, or the pitch range). */
+    int getAnalysisMaxLag() const noexcept;
 
-    /** Forward FFT, return magnitudes of the half-spectrum. */
-    void performFFT (const float* input, size_t length, std::vector<float>& magnitudes);
+    /** Pitch + voicing confidence for one frame, from its autocorrelation. */
+    void trackPitch (int frameIndex, const float* autocorrelation);
 
     /** Update internal buffers based on new windowSize or lpcOrder. */
     void updateInternalBuffers();
 
-    /** Reallocate the FFT object/buffer if needed. */
+    /** Resize (and clear) the per-channel history/overlap-add rings to windowSize. */
+    void updateChannelBuffers();
+
+    /** Prepare the autocorrelation transforms and lag buffer for the window size. */
     void updateFFTObject();
 
     /** (Optional) Regenerate Hann window. */
@@ -97,34 +188,45 @@ private:
 
     int lpcOrder = 0; ///< number of LPC coefficients (model order).
     int windowSize = 0; ///< size of analysis/synthesis window.
-    int hopSize = 0; ///< overlap step size (windowSize / 2, for 50% overlap).
+    int hopSize = 0; ///< step between frames (windowSize / 2 for overlap-add).
+    int ringSize = 0; ///< length of the history/output rings, max (windowSize, hopSize).
     double sampleRate = 44100.0; ///< sample rate for pitch detection.
+    double maxSampleRate = 44100.0; ///< rate passed to prepare(), the highest the pitch trackers allocate for.
 
     bool pitchDetectionEnabled = false;
-
-    // Preallocated data for one process call:
-    // Stacked, windowed input frames:
-    std::vector<std::vector<float>> stackedData;
-    // LPC coefficients for each frame:
-    std::vector<std::vector<float>> lpcCoefficients;
-    // Power per frame (for amplitude/gain):
-    std::vector<float> signalPowers;
-    // Pitch frequencies (Hz) per frame:
-    std::vector<float> pitchFrequencies;
-    // Synthesized frames:
-    std::vector<std::vector<float>> synthesizedData;
-
-    // Hann window coefficients:
+    bool doublePrecisionAnalysis = false;
+    bool stereoPackingEnabled = true;
+    LPCSynthesisFilter::Structure synthesisStructure = LPCSynthesisFilter::Structure::directForm;
+    SynthesisMode synthesisMode = SynthesisMode::overlapAdd;
+    int interpolatedHopSize = 0; ///< requested hop for the interpolated mode (0 = windowSize / 2).
+    int interpolationSubframes = defaultInterpolationSubframes;
+
+    // Streaming state:
+    std::vector<ChannelState> channels;
+    int maxBlockSize = 0; ///< largest block announced in prepare().
+    int maxFramesPerChunk = 0; ///< upper bound on hops completed by one chunk.
+    int ringPosition = 0; ///< shared write/read index into every channel's rings.
+    int samplesUntilNextHop = 0; ///< input samples still needed before the next frame.
+
+    // Sample offsets (within the current chunk) at which each frame completes:
+    std::vector<int> frameOffsets;
+    int numFramesInChunk = 0;
+
+    // Preallocated data for one chunk (frames are stored channel after channel):
+    // stacked frames, LPC and reflection coefficients, powers, pitches and synthesized frames.
+    LPCFrameArena arena;
+
+    // Hann window coefficients (periodic, so 50% overlap sums to unity):
     std::vector<float> hannWindow;
 
-    // For FFT-based autocorrelation & pitch detection:
-    std::unique_ptr<juce::dsp::FFT> fft;
-    int fftSize = 0; // actual size used by juce::dsp::FFT
-    std::vector<float> fftBuffer;
+    // Lags 0..lpcOrder for the Levinson-Durbin recursion:
+    Autocorrelator autocorrelator;
+
+    // Autocorrelation lags for the current frame (or stereo pair):
+    std::vector<float> lagBuffer;
 
-    // RNG for unvoiced frames:
-    std::mt19937 rng { 0xDEADBEEF };
-    std::uniform_real_distribution<float> dist { -1.0f, 1.0f };
+    // For stereo pairs: both channels in one complex transform
+    PackedStereoFFT stereoFFT;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LPCProcessor)
 };
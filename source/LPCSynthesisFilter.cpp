@@ -0,0 +1,201 @@
+#include "LPCSynthesisFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Keeps the derived lattice stable when a set of direct-form coefficients
+    // sits right on (or beyond) the unit circle.
+    constexpr float maxReflection = 0.999f;
+
+    inline float dotProduct (const float* a, const float* b, int n) noexcept
+    {
+        float acc = 0.0f;
+        for (int i = 0; i < n; ++i)
+            acc += a[i] * b[i];
+        return acc;
+    }
+}
+
+//==============================================================================
+void LPCSynthesisFilter::setStructure (Structure newStructure) noexcept
+{
+    if (newStructure == structure)
+        return;
+
+    structure = newStructure;
+    reset();
+}
+
+void LPCSynthesisFilter::reset() noexcept
+{
+    state.fill (0.0f);
+}
+
+void LPCSynthesisFilter::setCoefficients (const float* lpc, int newOrder) noexcept
+{
+    jassert (newOrder >= 0 && newOrder <= maxOrder);
+    order = juce::jlimit (0, maxOrder, newOrder);
+
+    for (int k = 0; k < order; ++k)
+        reversedLpc[(size_t) k] = lpc[order - 1 - k];
+
+    if (structure == Structure::lattice)
+        lpcToReflection (lpc, order, reflectionCoefs.data());
+}
+
+void LPCSynthesisFilter::setReflectionCoefficients (const float* reflection, int newOrder) noexcept
+{
+    jassert (newOrder >= 0 && newOrder <= maxOrder);
+    order = juce::jlimit (0, maxOrder, newOrder);
+
+    std::copy_n (reflection, order, reflectionCoefs.begin());
+
+    if (structure == Structure::directForm)
+    {
+        std::array<float, maxOrder> lpc {};
+        reflectionToLpc (reflection, order, lpc.data());
+
+        for (int k = 0; k < order; ++k)
+            reversedLpc[(size_t) k] = lpc[(size_t) (order - 1 - k)];
+    }
+}
+
+//==============================================================================
+void LPCSynthesisFilter::process (const float* input, float* output, int numSamples, float gain) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    if (structure == Structure::lattice)
+        processLattice (input, output, numSamples, gain);
+    else
+        processDirect (input, output, numSamples, gain);
+}
+
+void LPCSynthesisFilter::processFrame (const float* input, float* output, int numSamples, int commitLength, float gain) noexcept
+{
+    commitLength = juce::jlimit (0, numSamples, commitLength);
+
+    process (input, output, commitLength, gain);
+    const auto committedState = state;
+
+    process (input + commitLength, output + commitLength, numSamples - commitLength, gain);
+    state = committedState;
+}
+
+//==============================================================================
+void LPCSynthesisFilter::processDirect (const float* input, float* output, int numSamples, float gain) noexcept
+{
+    const float* taps = reversedLpc.data();
+
+    // Warm-up: the first 'order' outputs still reach back into the saved state, so
+    // run them through a small scratch line of [state | new outputs].
+    std::array<float, 2 * maxOrder> warmUp {};
+    std::copy_n (state.begin(), order, warmUp.begin());
+
+    const int numWarmUp = std::min (order, numSamples);
+    for (int n = 0; n < numWarmUp; ++n)
+    {
+        const float y = gain * input[n] - dotProduct (taps, warmUp.data() + n, order);
+        warmUp[(size_t) (order + n)] = y;
+        output[n] = y;
+    }
+
+    if (numSamples < order)
+    {
+        // Not enough new samples to replace the state entirely
+        std::copy_n (warmUp.begin() + numSamples, order, state.begin());
+        return;
+    }
+
+    // Steady state: every tap reads earlier outputs of this call, no branches
+    for (int n = order; n < numSamples; ++n)
+        output[n] = gain * input[n] - dotProduct (taps, output + n - order, order);
+
+    std::copy_n (output + numSamples - order, order, state.begin());
+}
+
+void LPCSynthesisFilter::processLattice (const float* input, float* output, int numSamples, float gain) noexcept
+{
+    const float* k = reflectionCoefs.data();
+    float* b = state.data();
+
+    if (order == 0)
+    {
+        juce::FloatVectorOperations::copyWithMultiply (output, input, gain, numSamples);
+        return;
+    }
+
+    const int top = order - 1;
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        // Top stage: f_{p-1} = f_p - k_p b_{p-1}[n-1] (b_p itself is never needed)
+        float f = gain * input[n] - k[top] * b[top];
+
+        // Descend the remaining stages: f_{m} = f_{m+1} - k_{m+1} b_m[n-1],
+        //                               b_{m+1}[n] = b_m[n-1] + k_{m+1} f_m[n]
+        for (int m = top - 1; m >= 0; --m)
+        {
+            f -= k[m] * b[m];
+            b[m + 1] = b[m] + k[m] * f;
+        }
+
+        b[0] = f;
+        output[n] = f;
+    }
+}
+
+//==============================================================================
+void LPCSynthesisFilter::lpcToReflection (const float* lpc, int order, float* reflection) noexcept
+{
+    std::array<float, maxOrder> a {};
+    std::copy_n (lpc, order, a.begin());
+
+    for (int m = order; m > 0; --m)
+    {
+        const float km = juce::jlimit (-maxReflection, maxReflection, a[(size_t) (m - 1)]);
+        reflection[m - 1] = km;
+
+        const float scale = 1.0f / (1.0f - km * km);
+        std::array<float, maxOrder> previous = a;
+
+        for (int j = 1; j < m; ++j)
+            a[(size_t) (j - 1)] = (previous[(size_t) (j - 1)] - km * previous[(size_t) (m - j - 1)]) * scale;
+    }
+}
+
+void LPCSynthesisFilter::reflectionToLpc (const float* reflection, int order, float* lpc) noexcept
+{
+    std::array<float, maxOrder> previous {};
+
+    for (int m = 1; m <= order; ++m)
+    {
+        const float km = reflection[m - 1];
+        std::copy_n (lpc, m - 1, previous.begin());
+
+        for (int j = 1; j < m; ++j)
+            lpc[j - 1] = previous[(size_t) (j - 1)] + km * previous[(size_t) (m - j - 1)];
+
+        lpc[m - 1] = km;
+    }
+}
+
+void LPCSynthesisFilter::reflectionToLogArea (const float* reflection, int order, float* logArea) noexcept
+{
+    for (int m = 0; m < order; ++m)
+    {
+        // Levinson-Durbin already keeps |k| <= 0.999, this only guards the log
+        const float k = juce::jlimit (-0.9999f, 0.9999f, reflection[m]);
+        logArea[m] = std::log ((1.0f + k) / (1.0f - k));
+    }
+}
+
+void LPCSynthesisFilter::logAreaToReflection (const float* logArea, int order, float* reflection) noexcept
+{
+    // Inverse of the above: k = (e^g - 1) / (e^g + 1) = tanh (g / 2)
+    for (int m = 0; m < order; ++m)
+        reflection[m] = std::tanh (0.5f * logArea[m]);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <array>
+
+/**
+    All-pole LPC synthesis filter 1 / A(z), with A(z) = 1 + a1 z^-1 + ... + ap z^-p.
+
+    Unlike filtering each frame from silence, the filter keeps its state between
+    calls, so consecutive frames and hops continue from where the signal left off.
+    Two structures are available at runtime:
+    - directForm: y[n] = g x[n] - sum a[k] y[n - k], cheapest per sample
+    - lattice:    driven by the reflection coefficients, better behaved when the
+                  coefficients change from frame to frame
+
+    Both inner loops are branch-free: the first p samples of a call (which still
+    reach back into the saved state) are handled separately from the rest.
+*/
+class LPCSynthesisFilter
+{
+public:
+    enum class Structure
+    {
+        directForm,
+        lattice
+    };
+
+    static constexpr int maxOrder = 24;
+
+    LPCSynthesisFilter() = default;
+
+    //==========================================================================
+    /** Switches structure. The state is cleared because it isn't transferable. */
+    void setStructure (Structure newStructure) noexcept;
+    Structure getStructure() const noexcept { return structure; }
+
+    /** Clears the filter memory. */
+    void reset() noexcept;
+
+    /** Sets direct-form coefficients a1..ap (the reflection coefficients are derived). */
+    void setCoefficients (const float* lpc, int newOrder) noexcept;
+
+    /** Sets reflection coefficients k1..kp (the direct-form coefficients are derived). */
+    void setReflectionCoefficients (const float* reflection, int newOrder) noexcept;
+
+    int getOrder() const noexcept { return order; }
+
+    //==========================================================================
+    /** Filters gain * input into output, continuing from the current state.
+        input and output may point to the same memory.
+    */
+    void process (const float* input, float* output, int numSamples, float gain) noexcept;
+
+    /** Filters a whole overlap-add frame, but leaves the state as it was after the
+        first commitLength samples, which is where the next frame (one hop later)
+        starts.
+    */
+    void processFrame (const float* input, float* output, int numSamples, int commitLength, float gain) noexcept;
+
+    //==========================================================================
+    /** Step-down recursion: direct-form coefficients -> reflection coefficients. */
+    static void lpcToReflection (const float* lpc, int order, float* reflection) noexcept;
+
+    /** Step-up recursion: reflection coefficients -> direct-form coefficients. */
+    static void reflectionToLpc (const float* reflection, int order, float* lpc) noexcept;
+
+    /** Reflection coefficients -> log-area ratios log((1 + k) / (1 - k)).
+        Any blend of two LAR sets maps back to a stable filter, so they're the
+        domain to interpolate in.
+    */
+    static void reflectionToLogArea (const float* reflection, int order, float* logArea) noexcept;
+
+    /** Log-area ratios -> reflection coefficients (|k| < 1 for any input). */
+    static void logAreaToReflection (const float* logArea, int order, float* reflection) noexcept;
+
+private:
+    //==========================================================================
+    void processDirect (const float* input, float* output, int numSamples, float gain) noexcept;
+    void processLattice (const float* input, float* output, int numSamples, float gain) noexcept;
+
+    Structure structure = Structure::directForm;
+    int order = 0;
+
+    std::array<float, maxOrder> reversedLpc {}; ///< a_p .. a_1, so the tap loop walks forwards in time.
+    std::array<float, maxOrder> reflectionCoefs {}; ///< k_1 .. k_p
+
+    // Direct form: the last 'order' outputs, oldest first.
+    // Lattice: backward errors b_0[n-1] .. b_{p-1}[n-1].
+    std::array<float, maxOrder> state {};
+
+    JUCE_LEAK_DETECTOR (LPCSynthesisFilter)
+};
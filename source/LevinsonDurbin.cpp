@@ -0,0 +1,30 @@
+#include "LevinsonDurbin.h"
+
+#include <utility>
+
+namespace
+{
+    using Solver = float (*) (const float*, float*, float*) noexcept;
+
+    template <typename Accumulator, size_t... Orders>
+    constexpr std::array<Solver, sizeof...(Orders)> makeSolverTable (std::index_sequence<Orders...>)
+    {
+        return { &LevinsonDurbin::solveFixed<(int) Orders + 1, Accumulator>... };
+    }
+
+    constexpr auto floatSolvers = makeSolverTable<float> (std::make_index_sequence<LevinsonDurbin::maxOrder> {});
+    constexpr auto doubleSolvers = makeSolverTable<double> (std::make_index_sequence<LevinsonDurbin::maxOrder> {});
+}
+
+float LevinsonDurbin::solve (const float* autocorrelation, int order, float* lpc, float* reflection, bool useDoublePrecision) noexcept
+{
+    jassert (order >= 1 && order <= maxOrder);
+
+    if (order < 1)
+        return std::max (autocorrelation[0], 1e-12f);
+
+    order = std::min (order, maxOrder);
+
+    const auto& table = useDoublePrecision ? doubleSolvers : floatSolvers;
+    return table[(size_t) (order - 1)] (autocorrelation, lpc, reflection);
+}
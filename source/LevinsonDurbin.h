@@ -0,0 +1,80 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <algorithm>
+#include <array>
+
+/**
+    Levinson-Durbin recursion: autocorrelation lags 0..p -> LPC coefficients.
+
+    Produces A(z) = 1 + a1 z^-1 + ... + ap z^-p (the convention LPCSynthesisFilter
+    uses), plus the reflection coefficients k1..kp and the final prediction
+    error as by-products.
+
+    Every order from 1 to maxOrder has its own instantiation of solveFixed(), so
+    the loop bounds are compile-time constants and all scratch lives in small
+    fixed-size arrays on the stack. solve() picks the right instantiation
+    through a lookup table. Accumulating in double costs a little more but keeps
+    high orders well conditioned on strongly resonant material.
+*/
+class LevinsonDurbin
+{
+public:
+    static constexpr int maxOrder = 24;
+
+    /** Reflection coefficients are clamped to this magnitude to guarantee a stable model. */
+    static constexpr float maxReflection = 0.999f;
+
+    /** Solves for the given order (1..maxOrder). autocorrelation must hold order + 1 lags;
+        lpc and reflection receive order values each. Returns the final prediction error.
+    */
+    static float solve (const float* autocorrelation,
+        int order,
+        float* lpc,
+        float* reflection,
+        bool useDoublePrecision = false) noexcept;
+
+    /** The recursion for one fixed order. Accumulator is float or double. */
+    template <int Order, typename Accumulator>
+    static float solveFixed (const float* autocorrelation, float* lpc, float* reflection) noexcept
+    {
+        static_assert (Order >= 1 && Order <= maxOrder);
+
+        std::array<Accumulator, Order> a {};
+        Accumulator error = std::max ((Accumulator) autocorrelation[0], (Accumulator) 1e-12);
+
+        for (int i = 1; i <= Order; ++i)
+        {
+            Accumulator acc = (Accumulator) autocorrelation[i];
+            for (int j = 1; j < i; ++j)
+                acc += a[(size_t) (j - 1)] * (Accumulator) autocorrelation[i - j];
+
+            const auto k = std::clamp (-acc / error, (Accumulator) -maxReflection, (Accumulator) maxReflection);
+
+            // In-place symmetric update of a1..a(i-1): a[j] += k * a[i-j] for every j,
+            // including the middle coefficient when i - 1 is odd
+            const int m = i - 1;
+            for (int j = 0; j < m / 2; ++j)
+            {
+                const Accumulator lo = a[(size_t) j];
+                const Accumulator hi = a[(size_t) (m - 1 - j)];
+                a[(size_t) j] = lo + k * hi;
+                a[(size_t) (m - 1 - j)] = hi + k * lo;
+            }
+
+            if ((m & 1) != 0)
+                a[(size_t) (m / 2)] += k * a[(size_t) (m / 2)];
+
+            a[(size_t) m] = k;
+            reflection[m] = (float) k;
+
+            error = std::max (error * ((Accumulator) 1 - k * k), (Accumulator) 1e-12); // avoid blow-ups
+        }
+
+        for (int j = 0; j < Order; ++j)
+            lpc[j] = (float) a[(size_t) j];
+
+        return (float) error;
+    }
+};
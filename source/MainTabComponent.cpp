@@ -26,6 +26,9 @@ MainTabComponent::MainTabComponent (PluginProcessor& p)
     addAndMakeVisible (optionsButton);
 
     optionsButton.addListener (this);
+
+    // paint() fills the whole page
+    setOpaque (true);
 }
 
 MainTabComponent::~MainTabComponent()
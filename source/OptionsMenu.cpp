@@ -5,7 +5,15 @@ OptionsMenu::OptionsMenu(PluginProcessor& p)
       smoothingSlider("Smoothing Value"),
       smoothingAttachment(processorRef.apvts, "VIS_SMOOTH", smoothingSlider.slider)
 {
+    // Combo boxes need their items before the attachments sync them to the parameters
+    fftSizeBox.addItemList(processorRef.apvts.getParameter("VIS_FFT_SIZE")->getAllValueStrings(), 1);
+    overlapBox.addItemList(processorRef.apvts.getParameter("VIS_OVERLAP")->getAllValueStrings(), 1);
+    fftSizeAttachment = std::make_unique<ComboBoxAttachment>(processorRef.apvts, "VIS_FFT_SIZE", fftSizeBox);
+    overlapAttachment = std::make_unique<ComboBoxAttachment>(processorRef.apvts, "VIS_OVERLAP", overlapBox);
+
     addAndMakeVisible(smoothingSlider);
+    addAndMakeVisible(fftSizeBox);
+    addAndMakeVisible(overlapBox);
     addAndMakeVisible(closeButton);
 
     closeButton.addListener(this);
@@ -30,7 +38,10 @@ void OptionsMenu::resized()
     auto area = getLocalBounds().reduced(10);
 
 
-    smoothingSlider.setBounds(area.removeFromTop(50).removeFromLeft(150));
+    auto topRow = area.removeFromTop(50);
+    smoothingSlider.setBounds(topRow.removeFromLeft(150));
+    fftSizeBox.setBounds(topRow.removeFromLeft(120).reduced(5, 12));
+    overlapBox.setBounds(topRow.removeFromLeft(100).reduced(5, 12));
     closeButton.setBounds(area.removeFromBottom(30).removeFromRight(80));
 }
 
@@ -28,9 +28,14 @@ private:
     // Smoothing Slider
     SliderWithLabel smoothingSlider;
 
+    // Analyzer FFT size and overlap
+    juce::ComboBox fftSizeBox, overlapBox;
+
     // Attachments
     using Attachment = juce::AudioProcessorValueTreeState::SliderAttachment;
+    using ComboBoxAttachment = juce::AudioProcessorValueTreeState::ComboBoxAttachment;
     Attachment smoothingAttachment;
+    std::unique_ptr<ComboBoxAttachment> fftSizeAttachment, overlapAttachment;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OptionsMenu)
 };
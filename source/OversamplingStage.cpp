@@ -0,0 +1,38 @@
+#include "OversamplingStage.h"
+
+#include <cmath>
+
+//==============================================================================
+void OversamplingStage::prepare (int numChannels, int maximumBlockSize, int newFactorOrder, FilterType newFilterType)
+{
+    factorOrder = juce::jlimit (0, maxFactorOrder, newFactorOrder);
+    filterType = newFilterType;
+    numChannels = juce::jmax (1, numChannels);
+
+    channelPointers.assign ((size_t) numChannels, nullptr);
+
+    if (factorOrder == 0)
+    {
+        oversampling.reset();
+        return;
+    }
+
+    const auto type = filterType == FilterType::iir
+                          ? juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR
+                          : juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple;
+
+    // Maximum-quality filters, with the latency rounded up to whole host samples
+    oversampling = std::make_unique<juce::dsp::Oversampling<float>> ((size_t) numChannels, (size_t) factorOrder, type, true, true);
+    oversampling->initProcessing ((size_t) juce::jmax (1, maximumBlockSize));
+}
+
+void OversamplingStage::reset() noexcept
+{
+    if (oversampling != nullptr)
+        oversampling->reset();
+}
+
+int OversamplingStage::getLatencySamples() const noexcept
+{
+    return oversampling != nullptr ? (int) std::lround (oversampling->getLatencyInSamples()) : 0;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+
+#include <memory>
+#include <vector>
+
+/**
+    Runs a chain of effects at 1x, 2x, 4x or 8x the host rate.
+
+    A thin wrapper over juce::dsp::Oversampling that hands the oversampled
+    block to the effects as an AudioBuffer view (no copies), so stages written
+    for host buffers run unchanged inside it. At 1x the effects run straight on
+    the host buffer.
+
+    The half-band filters are either polyphase IIR (cheap, minimum latency,
+    non-linear phase) or linear-phase FIR (exact phase, more latency). Either
+    way the latency is rounded to whole host samples so it can be reported.
+*/
+class OversamplingStage
+{
+public:
+    enum class FilterType
+    {
+        iir,
+        linearPhase
+    };
+
+    static constexpr int maxFactorOrder = 3; ///< 2^3 = 8x.
+
+    OversamplingStage() = default;
+
+    //==========================================================================
+    /** Builds the filters for 2^factorOrder oversampling (off the audio thread). */
+    void prepare (int numChannels, int maximumBlockSize, int newFactorOrder, FilterType newFilterType);
+
+    /** Clears the filter states. */
+    void reset() noexcept;
+
+    int getFactorOrder() const noexcept { return factorOrder; }
+    int getFactor() const noexcept { return 1 << factorOrder; }
+    FilterType getFilterType() const noexcept { return filterType; }
+
+    /** Latency of the up + down filters, in host samples. */
+    int getLatencySamples() const noexcept;
+
+    //==========================================================================
+    /** Upsamples the buffer, runs processOversampled on the oversampled view and
+        downsamples the result back into the buffer.
+    */
+    template <typename ProcessFunction>
+    void process (juce::AudioBuffer<float>& buffer, ProcessFunction&& processOversampled) noexcept
+    {
+        if (oversampling == nullptr)
+        {
+            processOversampled (buffer);
+            return;
+        }
+
+        juce::dsp::AudioBlock<float> block (buffer);
+        auto oversampled = oversampling->processSamplesUp (block);
+
+        const int numChannels = juce::jmin ((int) oversampled.getNumChannels(), (int) channelPointers.size());
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            channelPointers[(size_t) ch] = oversampled.getChannelPointer ((size_t) ch);
+
+        juce::AudioBuffer<float> view (channelPointers.data(), numChannels, (int) oversampled.getNumSamples());
+        processOversampled (view);
+
+        oversampling->processSamplesDown (block);
+    }
+
+private:
+    //==========================================================================
+    std::unique_ptr<juce::dsp::Oversampling<float>> oversampling; ///< null at 1x.
+    std::vector<float*> channelPointers;
+
+    int factorOrder = 0;
+    FilterType filterType = FilterType::iir;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OversamplingStage)
+};
@@ -0,0 +1,70 @@
+#include "PackedStereoFFT.h"
+
+#include <algorithm>
+#include <cmath>
+
+//==============================================================================
+void PackedStereoFFT::prepare (int maxLength)
+{
+    const int newSize = juce::nextPowerOfTwo (2 * juce::jmax (1, maxLength));
+
+    if (newSize == fftSize && fft != nullptr)
+        return;
+
+    fftSize = newSize;
+    fft = std::make_unique<juce::dsp::FFT> ((int) std::log2 ((double) fftSize));
+    timeDomain.assign ((size_t) fftSize, {});
+    spectrum.assign ((size_t) fftSize, {});
+}
+
+//==============================================================================
+void PackedStereoFFT::computePowerSpectra (const float* left, const float* right, int length) noexcept
+{
+    jassert (fft != nullptr && length <= fftSize); // call prepare() with a big enough size
+
+    for (int n = 0; n < length; ++n)
+        timeDomain[(size_t) n] = { left[n], right[n] };
+
+    std::fill (timeDomain.begin() + length, timeDomain.end(), juce::dsp::Complex<float> {});
+
+    fft->perform (timeDomain.data(), spectrum.data(), false);
+
+    // Separate the two spectra. Bin k and its mirror N - k share both power values,
+    // so only 0..N/2 is written and the upper half is rebuilt when needed.
+    const int half = fftSize / 2;
+
+    for (int k = 0; k <= half; ++k)
+    {
+        const auto z = spectrum[(size_t) k];
+        const auto mirror = spectrum[(size_t) ((fftSize - k) % fftSize)];
+
+        // L = (z + conj (mirror)) / 2,  R = (z - conj (mirror)) / 2i
+        const float lRe = 0.5f * (z.real() + mirror.real());
+        const float lIm = 0.5f * (z.imag() - mirror.imag());
+        const float rRe = 0.5f * (z.imag() + mirror.imag());
+        const float rIm = 0.5f * (mirror.real() - z.real());
+
+        spectrum[(size_t) k] = { lRe * lRe + lIm * lIm, rRe * rRe + rIm * rIm };
+    }
+}
+
+void PackedStereoFFT::computeAutocorrelations (const float* left, const float* right, int length, int maxLag, float* destLeft, float* destRight) noexcept
+{
+    computePowerSpectra (left, right, length);
+
+    // Both power spectra are real and even, so mirror the lower half and
+    // let one inverse transform produce both lag sequences
+    const int half = fftSize / 2;
+
+    for (int k = 1; k < half; ++k)
+        spectrum[(size_t) (fftSize - k)] = spectrum[(size_t) k];
+
+    // JUCE scales the inverse by 1 / fftSize, so the lags come out unnormalised
+    fft->perform (spectrum.data(), timeDomain.data(), true);
+
+    for (int k = 0; k <= maxLag; ++k)
+    {
+        destLeft[k] = k < length ? timeDomain[(size_t) k].real() : 0.0f;
+        destRight[k] = k < length ? timeDomain[(size_t) k].imag() : 0.0f;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <memory>
+#include <vector>
+
+/**
+    Analyses two real frames (left/right) with a single complex FFT.
+
+    The frames go into the real and imaginary parts of one complex signal
+    z = l + i r. Because l and r are real, their spectra can be recovered from
+    Z by conjugate symmetry:
+
+        L[k] = (Z[k] + conj (Z[N - k])) / 2
+        R[k] = (Z[k] - conj (Z[N - k])) / 2i
+
+    so |L|^2 and |R|^2 cost one transform instead of two. For the
+    autocorrelations the two (real, even) power spectra are packed again as
+    |L|^2 + i |R|^2, and one inverse transform returns both lag sequences in its
+    real and imaginary parts: two FFTs per stereo pair instead of four.
+*/
+class PackedStereoFFT
+{
+public:
+    PackedStereoFFT() = default;
+
+    /** Builds the transform for frames of up to maxLength samples (zero-padded to 2 * maxLength). */
+    void prepare (int maxLength);
+
+    int getFFTSize() const noexcept { return fftSize; }
+
+    /** Writes lags 0..maxLag of both (unnormalised) autocorrelations. */
+    void computeAutocorrelations (const float* left, const float* right, int length, int maxLag, float* destLeft, float* destRight) noexcept;
+
+private:
+    /** Forward-transforms left + i * right into spectrum, then replaces each bin 0..N/2
+        with the separated power spectra: re = |L|^2, im = |R|^2. */
+    void computePowerSpectra (const float* left, const float* right, int length) noexcept;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    int fftSize = 0;
+    std::vector<juce::dsp::Complex<float>> timeDomain, spectrum;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PackedStereoFFT)
+};
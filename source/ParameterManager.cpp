@@ -4,9 +4,59 @@
 
 #include "ParameterManager.h"
 
+#include <utility>
+
+namespace
+{
+    struct ParameterInfo
+    {
+        ParameterManager::Parameter parameter;
+        const char* id;
+        ParameterManager::Effect effect;
+    };
+
+    using P = ParameterManager::Parameter;
+    using E = ParameterManager::Effect;
+
+    // Registry: one row per parameter, in Parameter order
+    constexpr std::array<ParameterInfo, ParameterManager::numParameters> parameterTable { {
+        { P::inGain, "IN", E::global },
+        { P::outGain, "OUT", E::global },
+        { P::overallMix, "OVERALL_MIX", E::global },
+        { P::bypass, "BYPASS", E::global },
+        { P::lpcSampleRate, "LPC_SAMPLE_RATE", E::lpc },
+        { P::lpcOrder, "LPC_ORDER", E::lpc },
+        { P::lpcAlpha, "LPC_ALPHA", E::lpc },
+        { P::pitchDetection, "PITCH_DETECTION", E::lpc },
+        { P::bitDepth, "BIT_DEPTH", E::redux },
+        { P::reduxRate, "REDUX_RATE", E::redux },
+        { P::dither, "DITHER", E::redux },
+        { P::noiseShaping, "NOISE_SHAPING", E::redux },
+        { P::reduxAntiAlias, "REDUX_ANTI_ALIAS", E::redux },
+        { P::oversampling, "OVERSAMPLING", E::oversampling },
+        { P::offlineOversampling, "OVERSAMPLING_OFFLINE", E::oversampling },
+        { P::oversamplingLinearPhase, "OVERSAMPLING_LINEAR_PHASE", E::oversampling },
+        { P::visSmooth, "VIS_SMOOTH", E::visualizer },
+        { P::visFftSize, "VIS_FFT_SIZE", E::visualizer },
+        { P::visOverlap, "VIS_OVERLAP", E::visualizer },
+    } };
+
+    constexpr bool isInParameterOrder()
+    {
+        for (size_t i = 0; i < parameterTable.size(); ++i)
+            if ((size_t) parameterTable[i].parameter != i)
+                return false;
+
+        return true;
+    }
+
+    static_assert (isInParameterOrder(), "parameterTable rows must follow the Parameter enum");
+}
+
 ParameterManager::ParameterManager(juce::AudioProcessorValueTreeState& state) : apvts(state)
 {
     mapParametersToEffects();
+    updateParameters();
 }
 
 ParameterManager::~ParameterManager()
@@ -15,47 +65,103 @@ ParameterManager::~ParameterManager()
 
 void ParameterManager::mapParametersToEffects()
 {
-    // Map parameter IDs to effects
-
-    // Global parameters
-    effectParameters["Global"] = {
-        apvts.getParameter("IN"),
-        apvts.getParameter("OUT"),
-        apvts.getParameter("BYPASS"),
-        apvts.getParameter("VIS_SMOOTH"),
-        apvts.getParameter("LPC_ORDER"),
-        apvts.getParameter("LPC_ALPHA")
-    };
-}
+    // The only string lookups: each ID is resolved once, here
+    for (const auto& info : parameterTable)
+    {
+        const auto index = (size_t) info.parameter;
 
+        values[index] = apvts.getRawParameterValue (info.id);
+        parameters[index] = apvts.getParameter (info.id);
+        jassert (values[index] != nullptr && parameters[index] != nullptr);
 
-void ParameterManager::categorizeParameters()
-{
-    // Parameters are already categorized in mapParametersToEffects
-    // This function can be expanded if dynamic categorization is needed
+        effectParameters[(size_t) info.effect].push_back (parameters[index]);
+        effectFlags[(size_t) info.effect] |= flagFor (info.parameter);
+    }
 }
 
-void ParameterManager::updateParameters()
+void ParameterManager::prepare (double sampleRate, double rampLengthSeconds)
 {
-    // Bulk update parameters from the APVTS
+    updateParameters();
 
-    // Global parameters
-    inGain = apvts.getRawParameterValue("IN")->load();
-    outGain = apvts.getRawParameterValue("OUT")->load();
-    mix = apvts.getRawParameterValue ("OVERALL_MIX")->load();
-    bypass = apvts.getRawParameterValue("BYPASS")->load() > 0.5f;
-    visSmooth = apvts.getRawParameterValue("VIS_SMOOTH")->load();
+    inGain.reset (sampleRate, rampLengthSeconds);
+    outGain.reset (sampleRate, rampLengthSeconds);
+    mix.reset (sampleRate, rampLengthSeconds);
 
-    lpcOrder = apvts.getRawParameterValue ("LPC_ORDER")->load();
-    lpcAlpha = apvts.getRawParameterValue ("LPC_ALPHA")->load();
-    pitchDetection = apvts.getRawParameterValue ("PITCH_DETECTION")->load();
-    lpcSampleRate = apvts.getRawParameterValue ("LPC_SAMPLE_RATE")->load();
+    inGain.setCurrentAndTargetValue (juce::Decibels::decibelsToGain (snapshot.inGainDb));
+    outGain.setCurrentAndTargetValue (juce::Decibels::decibelsToGain (snapshot.outGainDb));
+    mix.setCurrentAndTargetValue (snapshot.mix);
 
+    pendingFlags = allParameterFlags;
 }
 
-void ParameterManager::updateEffectParameters()
+const ParameterManager::Snapshot& ParameterManager::updateParameters() noexcept
 {
-    // Update the effect instances with the new parameter values
+    Snapshot next;
+    next.inGainDb = load (Parameter::inGain);
+    next.outGainDb = load (Parameter::outGain);
+    next.mix = load (Parameter::overallMix) * 0.01f;
+    next.bypass = load (Parameter::bypass) > 0.5f;
+    next.lpcSampleRate = load (Parameter::lpcSampleRate);
+    next.lpcOrder = juce::roundToInt (load (Parameter::lpcOrder));
+    next.lpcAlpha = load (Parameter::lpcAlpha);
+    next.pitchDetection = load (Parameter::pitchDetection) > 0.5f;
+    next.bitDepth = load (Parameter::bitDepth);
+    next.reduxRate = load (Parameter::reduxRate);
+    next.dither = load (Parameter::dither) > 0.5f;
+    next.noiseShaping = load (Parameter::noiseShaping) > 0.5f;
+    next.reduxAntiAlias = load (Parameter::reduxAntiAlias) > 0.5f;
+    next.oversamplingOrder = juce::roundToInt (load (Parameter::oversampling));
+    next.offlineOversamplingOrder = juce::roundToInt (load (Parameter::offlineOversampling)) - 1;
+    next.oversamplingLinearPhase = load (Parameter::oversamplingLinearPhase) > 0.5f;
+    next.visSmooth = load (Parameter::visSmooth);
+    next.visFftOrder = 9 + juce::roundToInt (load (Parameter::visFftSize)); // choice 0 = 512 points
+    next.visOverlapFactor = load (Parameter::visOverlap) > 0.5f ? 4 : 2;
+
+    changedFlags = std::exchange (pendingFlags, 0u);
+
+    auto flag = [this] (Parameter parameter, bool changed) {
+        if (changed)
+            changedFlags |= flagFor (parameter);
+    };
+
+    flag (Parameter::inGain, next.inGainDb != snapshot.inGainDb);
+    flag (Parameter::outGain, next.outGainDb != snapshot.outGainDb);
+    flag (Parameter::overallMix, next.mix != snapshot.mix);
+    flag (Parameter::bypass, next.bypass != snapshot.bypass);
+    flag (Parameter::lpcSampleRate, next.lpcSampleRate != snapshot.lpcSampleRate);
+    flag (Parameter::lpcOrder, next.lpcOrder != snapshot.lpcOrder);
+    flag (Parameter::lpcAlpha, next.lpcAlpha != snapshot.lpcAlpha);
+    flag (Parameter::pitchDetection, next.pitchDetection != snapshot.pitchDetection);
+    flag (Parameter::bitDepth, next.bitDepth != snapshot.bitDepth);
+    flag (Parameter::reduxRate, next.reduxRate != snapshot.reduxRate);
+    flag (Parameter::dither, next.dither != snapshot.dither);
+    flag (Parameter::noiseShaping, next.noiseShaping != snapshot.noiseShaping);
+    flag (Parameter::reduxAntiAlias, next.reduxAntiAlias != snapshot.reduxAntiAlias);
+    flag (Parameter::oversampling, next.oversamplingOrder != snapshot.oversamplingOrder);
+    flag (Parameter::offlineOversampling, next.offlineOversamplingOrder != snapshot.offlineOversamplingOrder);
+    flag (Parameter::oversamplingLinearPhase, next.oversamplingLinearPhase != snapshot.oversamplingLinearPhase);
+    flag (Parameter::visSmooth, next.visSmooth != snapshot.visSmooth);
+    flag (Parameter::visFftSize, next.visFftOrder != snapshot.visFftOrder);
+    flag (Parameter::visOverlap, next.visOverlapFactor != snapshot.visOverlapFactor);
+
+    snapshot = next;
 
+    // Gains ramp in the linear domain; the dB conversion only runs when they move
+    if (hasChanged (Parameter::inGain))
+        inGain.setTargetValue (juce::Decibels::decibelsToGain (snapshot.inGainDb));
 
+    if (hasChanged (Parameter::outGain))
+        outGain.setTargetValue (juce::Decibels::decibelsToGain (snapshot.outGainDb));
+
+    if (hasChanged (Parameter::overallMix))
+        mix.setTargetValue (snapshot.mix);
+
+    return snapshot;
+}
+
+void ParameterManager::skipSmoothing (int numSamples) noexcept
+{
+    inGain.skip (numSamples);
+    outGain.skip (numSamples);
+    mix.skip (numSamples);
 }
@@ -10,54 +10,142 @@
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
-#include <unordered_map>
-#include <string>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
+/**
+    Reads the APVTS once per block into a typed snapshot, without string lookups.
+
+    The raw std::atomic<float> handles are resolved once, at construction. Every
+    updateParameters() loads them into a Snapshot, flags which parameters differ
+    from the previous block (so the engine only reconfigures on real changes) and
+    retargets the smoothed gains and mix.
+*/
 class ParameterManager
 {
 public:
+    /** Every parameter, in registry order. */
+    enum class Parameter
+    {
+        inGain,
+        outGain,
+        overallMix,
+        bypass,
+        lpcSampleRate,
+        lpcOrder,
+        lpcAlpha,
+        pitchDetection,
+        bitDepth,
+        reduxRate,
+        dither,
+        noiseShaping,
+        reduxAntiAlias,
+        oversampling,
+        offlineOversampling,
+        oversamplingLinearPhase,
+        visSmooth,
+        visFftSize,
+        visOverlap,
+        numParameters
+    };
+
+    /** The effect (processing stage) each parameter belongs to. */
+    enum class Effect
+    {
+        global,
+        lpc,
+        redux,
+        oversampling,
+        visualizer,
+        numEffects
+    };
+
+    static constexpr int numParameters = (int) Parameter::numParameters;
+    static constexpr int numEffects = (int) Effect::numEffects;
+
+    /** One block's worth of parameter values, already converted to their real types. */
+    struct Snapshot
+    {
+        float inGainDb = 0.0f;
+        float outGainDb = 0.0f;
+        float mix = 0.5f; ///< OVERALL_MIX as a 0..1 fraction.
+        bool bypass = false;
+        float lpcSampleRate = 8000.0f;
+        int lpcOrder = 10;
+        float lpcAlpha = 0.95f;
+        bool pitchDetection = false;
+        float bitDepth = 24.0f;
+        float reduxRate = 96000.0f;
+        bool dither = false;
+        bool noiseShaping = false;
+        bool reduxAntiAlias = true;
+        int oversamplingOrder = 0; ///< realtime factor as a power of two (0 = 1x).
+        int offlineOversamplingOrder = -1; ///< for non-realtime renders, -1 = same as realtime.
+        bool oversamplingLinearPhase = false;
+        float visSmooth = 0.69f;
+        int visFftOrder = 11; ///< analyzer FFT size as a power of two.
+        int visOverlapFactor = 2; ///< analyzer frames per FFT length (2 = 50%, 4 = 75%).
+    };
+
     ParameterManager(juce::AudioProcessorValueTreeState& apvts);
     ~ParameterManager();
 
-    // Bulk update parameters from the APVTS
-    void updateParameters();
-
-    // Categorize parameters based on the effects they are relevant to
-    void categorizeParameters();
-
-    // Update relevant instances of effects (e.g., reverb)
-    void updateEffectParameters();
-
-    // Accessors for parameters
-    bool isBypassed() const { return bypass; }
-    float getInGain() const { return inGain; }
-    float getOutGain() const { return outGain; }
-    float getVisSmooth() const { return visSmooth; }
-    bool getPitchDetection() const { return pitchDetection; }
-
-    // Parameters
-    float inGain = 0.0f;
-    float outGain = 0.0f;
-    bool bypass = false;
-    float visSmooth = 0.69f;
-    int lpcOrder = 10;
-    float lpcAlpha = 0.5f;
-    bool pitchDetection = false;
-    float lpcSampleRate = 44100.0f;
-    float mix = 1.0f;
+    /** Sets the ramp rate of the smoothed values, snaps them to the current
+        parameters, and flags every parameter as changed for the next update.
+    */
+    void prepare (double sampleRate, double rampLengthSeconds = 0.05);
 
-private:
-    juce::AudioProcessorValueTreeState& apvts;
+    /** Loads every parameter into the snapshot (call once per block) and updates
+        the change flags and smoothing targets.
+    */
+    const Snapshot& updateParameters() noexcept;
 
-    // Store parameters categorized by effect
-    std::unordered_map<std::string, std::vector<juce::RangedAudioParameter*>> effectParameters;
+    const Snapshot& getSnapshot() const noexcept { return snapshot; }
+
+    /** True if the parameter changed in the last updateParameters() call. */
+    bool hasChanged (Parameter parameter) const noexcept { return (changedFlags & flagFor (parameter)) != 0; }
+
+    /** True if any parameter of the effect changed in the last updateParameters() call. */
+    bool hasChanged (Effect effect) const noexcept { return (changedFlags & effectFlags[(size_t) effect]) != 0; }
+
+    /** Smoothed linear gains and mix, to be applied (and so advanced) by the audio thread. */
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>& getInGain() noexcept { return inGain; }
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>& getOutGain() noexcept { return outGain; }
+    juce::SmoothedValue<float>& getMix() noexcept { return mix; }
+
+    /** Advances every smoothed value without applying it (e.g. while bypassed). */
+    void skipSmoothing (int numSamples) noexcept;
 
-    // Internal function to map parameter IDs to effects
+    // Index-based registry
+    juce::RangedAudioParameter* getParameter (Parameter parameter) const noexcept { return parameters[(size_t) parameter]; }
+    const std::vector<juce::RangedAudioParameter*>& getEffectParameters (Effect effect) const noexcept { return effectParameters[(size_t) effect]; }
+
+private:
+    static constexpr uint32_t flagFor (Parameter parameter) noexcept { return 1u << (uint32_t) parameter; }
+    static constexpr uint32_t allParameterFlags = (1u << numParameters) - 1;
+
+    // Resolve the raw value handles and build the per-effect registry
     void mapParametersToEffects();
 
+    float load (Parameter parameter) const noexcept { return values[(size_t) parameter]->load (std::memory_order_relaxed); }
+
+    juce::AudioProcessorValueTreeState& apvts;
+
+    std::array<std::atomic<float>*, numParameters> values {};
+    std::array<juce::RangedAudioParameter*, numParameters> parameters {};
+
+    // Store parameters categorized by effect
+    std::array<std::vector<juce::RangedAudioParameter*>, numEffects> effectParameters;
+    std::array<uint32_t, numEffects> effectFlags {};
 
+    Snapshot snapshot;
+    uint32_t changedFlags = 0; ///< bit per Parameter, set by the last update.
+    uint32_t pendingFlags = allParameterFlags; ///< forced on the next update (e.g. after prepare()).
 
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> inGain { 1.0f }, outGain { 1.0f };
+    juce::SmoothedValue<float> mix { 0.5f };
 };
 
 
@@ -0,0 +1,221 @@
+#include "PitchTracker.h"
+
+#include <cmath>
+
+namespace
+{
+    // A candidate counts as "as good as the best" above this fraction of the best clarity
+    constexpr float candidateThreshold = 0.9f;
+
+    // Candidates within this relative distance of the previous period count as a continuation
+    constexpr float continuationTolerance = 0.15f;
+
+    // ...and are preferred if they reach this fraction of the best clarity
+    constexpr float continuationThreshold = 0.8f;
+}
+
+//==============================================================================
+void PitchTracker::prepare (int newWindowSize, double maxSampleRate)
+{
+    windowSize = juce::jmax (2, newWindowSize);
+
+    // Lags beyond half a frame overlap too little to be trusted, so the longest
+    // frame holds two of the longest periods at the highest rate
+    const int longestPeriod = (int) std::ceil (juce::jmax (1.0, maxSampleRate) / minFrequency) + 1;
+    const int maxFrameLength = juce::jmax (windowSize, 2 * longestPeriod);
+    nsdf.assign ((size_t) maxFrameLength / 2 + 1, 0.0f);
+
+    if (maxFrameLength > windowSize)
+    {
+        history.assign ((size_t) juce::nextPowerOfTwo (maxFrameLength), 0.0f);
+        ownFrame.assign ((size_t) maxFrameLength, 0.0f);
+        ownLags.assign ((size_t) maxFrameLength / 2 + 1, 0.0f);
+        autocorrelator = std::make_unique<Autocorrelator>();
+        autocorrelator->prepare (maxFrameLength);
+    }
+    else
+    {
+        history.clear();
+        ownFrame.clear();
+        ownLags.clear();
+        autocorrelator.reset();
+    }
+
+    updateLagRange();
+    clear();
+}
+
+void PitchTracker::clear() noexcept
+{
+    std::fill (history.begin(), history.end(), 0.0f);
+    historyPosition = 0;
+    reset();
+}
+
+void PitchTracker::setSampleRate (double newSampleRate) noexcept
+{
+    sampleRate = newSampleRate;
+    updateLagRange();
+}
+
+void PitchTracker::setFrequencyRange (float newMinimum, float newMaximum) noexcept
+{
+    minFrequency = juce::jmax (1.0f, newMinimum);
+    maxFrequency = juce::jmax (minFrequency, newMaximum);
+    updateLagRange();
+}
+
+void PitchTracker::updateLagRange() noexcept
+{
+    // Anything longer than prepare() made room for is out of reach
+    const int longestLag = juce::jmax (2, (int) nsdf.size() - 1);
+
+    maxLag = juce::jlimit (2, longestLag, (int) std::ceil (sampleRate / minFrequency) + 1);
+    minLag = juce::jlimit (1, maxLag - 1, (int) std::floor (sampleRate / maxFrequency));
+}
+
+//==============================================================================
+PitchTracker::Estimate PitchTracker::process (const float* frame, int length, const float* autocorrelation) noexcept
+{
+    jassert (length == windowSize);
+    return estimate (frame, length, autocorrelation);
+}
+
+void PitchTracker::pushSamples (const float* input, int numSamples) noexcept
+{
+    if (history.empty())
+        return;
+
+    const int mask = (int) history.size() - 1;
+
+    for (int i = 0; i < numSamples; ++i)
+        history[(size_t) ((historyPosition + i) & mask)] = input[i];
+
+    historyPosition = (historyPosition + numSamples) & mask;
+}
+
+PitchTracker::Estimate PitchTracker::processHistory() noexcept
+{
+    const int length = juce::jmin (2 * maxLag, (int) ownFrame.size());
+
+    if (length <= 0 || autocorrelator == nullptr)
+        return {};
+
+    // Unroll the newest 'length' samples, oldest first
+    const int mask = (int) history.size() - 1;
+
+    for (int n = 0; n < length; ++n)
+        ownFrame[(size_t) n] = history[(size_t) ((historyPosition - length + n) & mask)];
+
+    autocorrelator->compute (ownFrame.data(), length, maxLag, ownLags.data());
+    return estimate (ownFrame.data(), length, ownLags.data());
+}
+
+PitchTracker::Estimate PitchTracker::estimate (const float* frame, int length, const float* autocorrelation) noexcept
+{
+    const int lastLag = juce::jmin (maxLag, length / 2);
+
+    if (autocorrelation[0] <= 1.0e-9f || lastLag <= minLag)
+    {
+        previousPeriod = 0.0f;
+        return {};
+    }
+
+    // 1) NSDF with the incrementally updated normaliser m(tau)
+    double m = 2.0 * (double) autocorrelation[0];
+    nsdf[0] = 1.0f;
+
+    for (int tau = 1; tau <= lastLag; ++tau)
+    {
+        const float head = frame[tau - 1];
+        const float tail = frame[length - tau];
+        m -= (double) (head * head + tail * tail);
+        nsdf[(size_t) tau] = m > 1.0e-12 ? (float) (2.0 * autocorrelation[tau] / m) : 0.0f;
+    }
+
+    // 2) Key maxima: the highest point between each positive and the following
+    //    negative zero crossing, within the lag range
+    constexpr int maxCandidates = 32;
+    int candidates[maxCandidates];
+    int numCandidates = 0;
+    float bestClarity = 0.0f;
+
+    int tau = 1;
+    while (tau < lastLag && nsdf[(size_t) tau] > 0.0f) // skip the zero-lag lobe
+        ++tau;
+
+    while (tau < lastLag && numCandidates < maxCandidates)
+    {
+        while (tau < lastLag && nsdf[(size_t) tau] <= 0.0f)
+            ++tau;
+
+        int peak = tau;
+        while (tau < lastLag && nsdf[(size_t) tau] > 0.0f)
+        {
+            if (nsdf[(size_t) tau] > nsdf[(size_t) peak])
+                peak = tau;
+
+            ++tau;
+        }
+
+        if (peak >= minLag && peak < lastLag && nsdf[(size_t) peak] > 0.0f)
+        {
+            candidates[numCandidates++] = peak;
+            bestClarity = juce::jmax (bestClarity, nsdf[(size_t) peak]);
+        }
+    }
+
+    if (numCandidates == 0 || bestClarity < voicingThreshold)
+    {
+        previousPeriod = 0.0f;
+        return { 0.0f, juce::jmax (0.0f, bestClarity) };
+    }
+
+    // 3) Prefer continuing the previous period, otherwise take the first strong candidate
+    int chosen = -1;
+
+    if (previousPeriod > 0.0f)
+    {
+        for (int i = 0; i < numCandidates; ++i)
+        {
+            const auto lag = (float) candidates[i];
+            if (std::abs (lag - previousPeriod) <= continuationTolerance * previousPeriod
+                && nsdf[(size_t) candidates[i]] >= continuationThreshold * bestClarity)
+            {
+                chosen = candidates[i];
+                break;
+            }
+        }
+    }
+
+    if (chosen < 0)
+    {
+        for (int i = 0; i < numCandidates; ++i)
+        {
+            if (nsdf[(size_t) candidates[i]] >= candidateThreshold * bestClarity)
+            {
+                chosen = candidates[i];
+                break;
+            }
+        }
+    }
+
+    // 4) Parabolic interpolation around the chosen peak
+    const float left = nsdf[(size_t) chosen - 1];
+    const float centre = nsdf[(size_t) chosen];
+    const float right = nsdf[(size_t) chosen + 1];
+    const float curvature = left - 2.0f * centre + right;
+
+    float period = (float) chosen;
+    float clarity = centre;
+
+    if (curvature < 0.0f)
+    {
+        const float offset = 0.5f * (left - right) / curvature;
+        period += offset;
+        clarity = centre - 0.25f * (left - right) * offset;
+    }
+
+    previousPeriod = period;
+    return { (float) (sampleRate / period), juce::jlimit (0.0f, 1.0f, clarity) };
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Autocorrelator.h"
+
+#include <juce_core/juce_core.h>
+
+#include <vector>
+
+/**
+    McLeod pitch method (normalised square difference function) on top of an
+    autocorrelation that has already been computed.
+
+        nsdf (tau) = 2 r (tau) / m (tau),   m (tau) = sum x[j]^2 + x[j + tau]^2
+
+    r comes from the caller (the same lags LPC analysis uses, just more of
+    them), and m is updated incrementally from m (0) = 2 r (0), so tracking a
+    frame costs O(maxLag) on top of the shared autocorrelation.
+
+    The peak picking follows McLeod & Wyvill: the highest maximum between each
+    positive and negative zero crossing is a candidate, and the first candidate
+    within a fraction of the best one wins. Its height ("clarity", 0..1) is the
+    voiced/unvoiced confidence.
+
+    Tracking is incremental across hops: when the previous frame was voiced,
+    a candidate close to the previous period is preferred as long as it is
+    nearly as clear as the best one. That stops single-frame octave jumps.
+
+    Lags are only trusted up to half a frame, so the LPC window (512 samples)
+    can't hold the longest periods at higher rates: at 48 kHz it bottoms out
+    near 190 Hz. When that happens (needsOwnFrames()), the tracker analyses its
+    own frames of two of the longest periods instead, taken from the raw input
+    it is fed through pushSamples(), with an autocorrelation of its own.
+*/
+class PitchTracker
+{
+public:
+    struct Estimate
+    {
+        float frequency = 0.0f; ///< Hz, 0 when unvoiced.
+        float confidence = 0.0f; ///< NSDF clarity of the chosen peak (0..1).
+    };
+
+    PitchTracker() = default;
+
+    //==========================================================================
+    /** Allocates for frames of windowSize samples, and for frames long enough for the
+        lowest frequency at up to maxSampleRate. Off the audio thread.
+    */
+    void prepare (int windowSize, double maxSampleRate);
+
+    /** Sets the rate the frames are sampled at; recomputes the lag range without allocating. */
+    void setSampleRate (double newSampleRate) noexcept;
+
+    /** Sets the pitch search range in Hz. */
+    void setFrequencyRange (float newMinimum, float newMaximum) noexcept;
+
+    /** Clarity below this is reported as unvoiced. */
+    void setVoicingThreshold (float newThreshold) noexcept { voicingThreshold = newThreshold; }
+
+    /** Forgets the previous period. */
+    void reset() noexcept { previousPeriod = 0.0f; }
+
+    /** Forgets the previous period and the input pushed so far. */
+    void clear() noexcept;
+
+    /** Highest lag process() reads from the autocorrelation. */
+    int getMaxLag() const noexcept { return maxLag; }
+
+    /** True when the lowest frequency needs longer frames than the window, so the
+        estimates have to come from pushSamples() and processHistory().
+    */
+    bool needsOwnFrames() const noexcept { return 2 * maxLag > windowSize; }
+
+    //==========================================================================
+    /** Estimates the pitch of frame[0..length), given its autocorrelation for lags 0..getMaxLag(). */
+    Estimate process (const float* frame, int length, const float* autocorrelation) noexcept;
+
+    /** Appends raw input to the tracker's own history (only read when needsOwnFrames()). */
+    void pushSamples (const float* input, int numSamples) noexcept;
+
+    /** Estimates the pitch of the last 2 * getMaxLag() samples pushed. */
+    Estimate processHistory() noexcept;
+
+private:
+    void updateLagRange() noexcept;
+
+    /** NSDF peak picking on any frame length; lags beyond length / 2 are ignored. */
+    Estimate estimate (const float* frame, int length, const float* autocorrelation) noexcept;
+
+    double sampleRate = 44100.0;
+    float minFrequency = 60.0f, maxFrequency = 1000.0f;
+    float voicingThreshold = 0.6f;
+
+    int windowSize = 0;
+    int minLag = 1, maxLag = 1;
+
+    float previousPeriod = 0.0f; ///< in samples, 0 when the last frame was unvoiced.
+
+    std::vector<float> nsdf;
+
+    // Own frames, for periods the window is too short for:
+    std::vector<float> history; ///< raw input ring (power-of-two length).
+    int historyPosition = 0;
+    std::vector<float> ownFrame, ownLags;
+    std::unique_ptr<Autocorrelator> autocorrelator; ///< only built when needed, keeps the tracker movable.
+
+    JUCE_LEAK_DETECTOR (PitchTracker)
+};
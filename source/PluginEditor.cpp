@@ -1,5 +1,48 @@
 #include "PluginEditor.h"
 
+namespace
+{
+    /** Loads the asset tier (name@0.5x.png, name.png, name@2x.png, name@3x.png) that
+        best covers the given scale relative to the 1x image: the smallest tier at
+        or above it, else the largest there is.
+    */
+    juce::Image loadClosestTier (const juce::String& name, float requiredScale)
+    {
+        struct Tier { const char* suffix; float scale; };
+        constexpr Tier tiers[] = { { "@0.5x", 0.5f }, { "", 1.0f }, { "@2x", 2.0f }, { "@3x", 3.0f } };
+
+        juce::Image best;
+        float bestScale = 0.0f;
+
+        for (const auto& tier : tiers)
+        {
+            const auto filename = name + tier.suffix + ".png";
+
+            for (int i = 0; i < BinaryData::namedResourceListSize; ++i)
+            {
+                if (filename != BinaryData::originalFilenames[i])
+                    continue;
+
+                const bool better = best.isNull()
+                                 || (bestScale < requiredScale && tier.scale > bestScale)
+                                 || (tier.scale >= requiredScale && tier.scale < bestScale);
+
+                if (better)
+                {
+                    int size = 0;
+                    const auto* data = BinaryData::getNamedResource (BinaryData::namedResourceList[i], size);
+                    best = juce::ImageCache::getFromMemory (data, size);
+                    bestScale = tier.scale;
+                }
+            }
+        }
+
+        return best;
+    }
+
+    constexpr int backgroundWidth = 832; ///< main_ui.png, the 1x tier (832 x 1000).
+}
+
 PluginEditor::PluginEditor (PluginProcessor& p)
     : AudioProcessorEditor (&p),
       processorRef (p),
@@ -14,8 +57,9 @@ PluginEditor::PluginEditor (PluginProcessor& p)
     tabbedComponent.addTab("Main", juce::Colours::darkgrey, &mainTab, false);
     tabbedComponent.addTab("Reference", juce::Colours::darkgrey, &referenceTab, false);
 
-    uiBackground = juce::ImageCache::getFromMemory (BinaryData::main_ui_png,
-                                                       BinaryData::main_ui_pngSize);
+    // The background, tab pages and analyzer cover their whole bounds, so a repaint of
+    // one (e.g. every analyzer frame) doesn't cascade into the others
+    setOpaque (true);
 
     // addAndMakeVisible(tabbedComponent);
     // addAndMakeVisible (spectrumAnalyzer);
@@ -58,9 +102,31 @@ void PluginEditor::paint (juce::Graphics& g)
     // g.fillAll (juce::Colours::black);
     int width = getWidth();
     int height = getHeight();
-    g.drawImage(uiBackground, 0, 0, width, height, 0, 0, 832, 1000, false);
 
-    spectrumAnalyzer.setVisualizerSmoothingValue (processorRef.apvts.getRawParameterValue ("VIS_SMOOTH")->load());
+    // A 1:1 blit of the background, pre-scaled for this size and display
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (scaledBackground.isNull() || scale != backgroundScale
+        || scaledBackground.getWidth() != juce::roundToInt ((float) width * scale)
+        || scaledBackground.getHeight() != juce::roundToInt ((float) height * scale))
+        updateBackground (scale);
+
+    g.drawImageTransformed (scaledBackground, juce::AffineTransform::scale (1.0f / scale));
+}
+
+void PluginEditor::updateBackground (float scale)
+{
+    backgroundScale = scale;
+
+    const int pixelWidth = juce::jmax (1, juce::roundToInt ((float) getWidth() * scale));
+    const int pixelHeight = juce::jmax (1, juce::roundToInt ((float) getHeight() * scale));
+
+    uiBackground = loadClosestTier ("main_ui", (float) pixelWidth / (float) backgroundWidth);
+
+    scaledBackground = juce::Image (juce::Image::RGB, pixelWidth, pixelHeight, false);
+    juce::Graphics g (scaledBackground);
+    g.setImageResamplingQuality (juce::Graphics::highResamplingQuality);
+    g.drawImage (uiBackground, 0, 0, pixelWidth, pixelHeight, 0, 0, uiBackground.getWidth(), uiBackground.getHeight(), false);
 }
 
 void PluginEditor::resized()
@@ -31,8 +31,13 @@ private:
     std::unique_ptr<melatonin::Inspector> inspector;
     juce::TextButton inspectButton { "Inspect" };
 
-    // UI BG image
+    // UI BG image: the closest asset tier, and a copy pre-scaled to the editor's
+    // physical size (rebuilt only when the size or display scale changes)
     juce::Image uiBackground;
+    juce::Image scaledBackground;
+    float backgroundScale = 0.0f;
+
+    void updateBackground (float scale);
 
     // Tabbed Component
     juce::TabbedComponent tabbedComponent { juce::TabbedButtonBar::TabsAtTop };
@@ -1,10 +1,28 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
-#include "LPCProcessor.h"
+#include "LPCEngineManager.h"
 #include "ProtectYourEars.h"
 
 bool debugAudioProtection = false;
 
+namespace
+{
+    /** The parameters that need a rebuilt LPC engine when they change. */
+    LPCEngineManager::Config engineConfigFor (const ParameterManager::Snapshot& params)
+    {
+        LPCEngineManager::Config config;
+        config.lpcOrder = params.lpcOrder;
+        config.targetSampleRate = params.lpcSampleRate;
+        return config;
+    }
+
+    OversamplingStage::FilterType oversamplingFilterFor (const ParameterManager::Snapshot& params)
+    {
+        return params.oversamplingLinearPhase ? OversamplingStage::FilterType::linearPhase
+                                              : OversamplingStage::FilterType::iir;
+    }
+}
+
 //==============================================================================
 PluginProcessor::PluginProcessor()
      : AudioProcessor (BusesProperties()
@@ -16,9 +34,10 @@ PluginProcessor::PluginProcessor()
             #endif
               ),
     apvts (*this, nullptr, "Parameters", createParameterLayout()),
-    lpcProcessor (16, 512),
     paramManager (apvts)
 {
+    // Only polls a flag: oversampling changes need a re-prepare, which can't happen on the audio thread
+    startTimerHz (10);
 }
 
 PluginProcessor::~PluginProcessor() = default;
@@ -58,7 +77,10 @@ bool PluginProcessor::isMidiEffect() const
 
 double PluginProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // The wet path's delay: the last input is still coming out of the LPC engine (and
+    // its resamplers and overlap-add) for that long after the input stops
+    const double rate = getSampleRate();
+    return rate > 0.0 ? getWetLatencySamples() / rate : 0.0;
 }
 
 int PluginProcessor::getNumPrograms()
@@ -91,15 +113,93 @@ void PluginProcessor::changeProgramName (int index, const juce::String& newName)
 //==============================================================================
 void PluginProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    // Initialize LPC effect with current parameters
-    lpcProcessor.setWindowSize(samplesPerBlock/2);
-    lpcProcessor.setTargetSampleRate (sampleRate);
+    // Initialize LPC effect with current parameters.
+    // The window is fixed by the processor, the host block size only bounds how many
+    // hops a single processBlock call can complete. The LPC core runs at the
+    // LPC_SAMPLE_RATE, approximated by a rational up/down ratio of the (oversampled)
+    // host rate for the polyphase resamplers.
+    paramManager.prepare (sampleRate);
+    const auto& params = paramManager.getSnapshot();
+
+    // The chain runs at the oversampled rate. Offline renders can use a higher
+    // factor than realtime playback (isNonRealtime() is set before prepareToPlay).
+    oversampling.prepare (getTotalNumOutputChannels(), samplesPerBlock, oversamplingOrderFor (params), oversamplingFilterFor (params));
+    oversamplingChangePending = false;
+
+    const int factor = oversampling.getFactor();
+    const double chainSampleRate = sampleRate * factor;
+
+    lpcEngine.setPitchDetectionEnabled (params.pitchDetection);
+    lpcEngine.prepare (chainSampleRate, samplesPerBlock * factor, getTotalNumOutputChannels(), engineConfigFor (params));
+    setLatencySamples (getWetLatencySamples());
+    pendingLatencySamples = -1;
+
+    redux.prepare (chainSampleRate, getTotalNumOutputChannels());
+    updateRedux (params);
+
+    // Dry ring: room for the longest wet-path latency (the lowest LPC rate) plus a
+    // block. A power-of-two length lets the read/write positions wrap with a mask.
+    const double maxRateRatio = sampleRate / LPCEngine::minTargetSampleRate;
+    const int maxLatency = (int) std::ceil ((2 * engineConfigFor (params).windowSize + 256) * maxRateRatio)
+                         + oversampling.getLatencySamples();
+    dryBuffer.setSize (getTotalNumOutputChannels(), juce::nextPowerOfTwo (maxLatency + samplesPerBlock));
+    dryBuffer.clear();
+    dryWritePosition = 0;
+    dryLatency = getWetLatencySamples();
+    dryFadePosition = dryFadeLength = 0;
+
+    visualizerFifo.prepareForAudio (sampleRate);
+}
+
+void PluginProcessor::updateRedux (const ParameterManager::Snapshot& params) noexcept
+{
+    redux.setBitDepth (params.bitDepth);
+
+    // "Off" is the top of the range at any host rate (the default would otherwise hold at
+    // 96 kHz when running at 176.4 or 192 kHz), or anything at or above the host rate
+    // (not the higher oversampled one)
+    const bool reduxOff = params.reduxRate >= maxReduxRate || params.reduxRate >= getSampleRate();
+    redux.setTargetSampleRate (reduxOff ? 0.0 : params.reduxRate);
+    redux.setDitherEnabled (params.dither);
+    redux.setNoiseShapingEnabled (params.noiseShaping);
+    redux.setAntiAliasingEnabled (params.reduxAntiAlias);
+}
+
+int PluginProcessor::oversamplingOrderFor (const ParameterManager::Snapshot& params) const noexcept
+{
+    const int order = isNonRealtime() && params.offlineOversamplingOrder >= 0 ? params.offlineOversamplingOrder
+                                                                              : params.oversamplingOrder;
+    return juce::jlimit (0, OversamplingStage::maxFactorOrder, order);
+}
+
+int PluginProcessor::getWetLatencySamples() const noexcept
+{
+    // The engine reports its latency at the oversampled rate
+    const int factor = oversampling.getFactor();
+    return oversampling.getLatencySamples() + (lpcEngine.getLatencySamples() + factor / 2) / factor;
+}
+
+void PluginProcessor::timerCallback()
+{
+    logProtectYourEarsWarnings();
+
+    if (const int latency = pendingLatencySamples.exchange (-1); latency >= 0)
+        setLatencySamples (latency);
+
+    if (! oversamplingChangePending.load() || getSampleRate() <= 0.0)
+        return;
+
+    // Re-prepare with the processing suspended, so processBlock never sees a half-built chain
+    suspendProcessing (true);
+    prepareToPlay (getSampleRate(), getBlockSize());
+    suspendProcessing (false);
 }
 
 void PluginProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    lpcEngine.release();
 }
 
 bool PluginProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
@@ -124,98 +224,209 @@ bool PluginProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
   #endif
 }
 
-void PluginProcessor::FifoQueue::push(const juce::AudioBuffer<float>& buffer)
+void PluginProcessor::processBlock (juce::AudioBuffer<float>& inputBuffer,
+                                    juce::MidiBuffer& midiMessages)
 {
-    int start1, size1, start2, size2;
-    fifo.prepareToWrite(buffer.getNumSamples(), start1, size1, start2, size2);
+    // Ignore MIDI messages if not used
+    juce::ignoreUnused(midiMessages);
+
+    // Update parameters (one snapshot per block, no string lookups)
+    const auto& params = paramManager.updateParameters();
+    const int numSamples = inputBuffer.getNumSamples();
+
+    // Reconfigure the engine only for parameters that actually changed. This happens
+    // before the bypass check so that changes made while bypassed aren't lost.
+    if (paramManager.hasChanged (ParameterManager::Parameter::pitchDetection))
+        lpcEngine.setPitchDetectionEnabled (params.pitchDetection);
+
+    // A new order or LPC rate is only posted here: the new engine is built on a
+    // background thread and crossfaded in by lpcEngine.process() once it's ready
+    if (paramManager.hasChanged (ParameterManager::Parameter::lpcOrder)
+        || paramManager.hasChanged (ParameterManager::Parameter::lpcSampleRate))
+        lpcEngine.requestConfig (engineConfigFor (params));
+
+    if (paramManager.hasChanged (ParameterManager::Effect::redux))
+        updateRedux (params);
+
+    // A new oversampling factor or filter reallocates everything downstream, so it's
+    // left to the message thread (timerCallback); until then the old setup keeps running
+    if (oversamplingOrderFor (params) != oversampling.getFactorOrder()
+        || oversamplingFilterFor (params) != oversampling.getFilterType())
+        oversamplingChangePending = true;
+
+    if (params.bypass)
+    {
+        // Bypassed: the delayed dry signal, so the output stays aligned with the
+        // latency the host compensates for
+        paramManager.skipSmoothing (numSamples);
+        pushDry (inputBuffer, false);
+        mixDry (inputBuffer, true);
+        visualizerFifo.pushAudio (inputBuffer);
+        return;
+    }
+
+    // Every stage works in place on the host buffer:
+    // 1) input gain, keeping a copy of the gained input in the dry ring
+    pushDry (inputBuffer, true);
 
-    if (size1 > 0)
-        circularBuffer.copyFrom(0, start1, buffer, 0, 0, size1);
-    if (size2 > 0)
-        circularBuffer.copyFrom(0, start2, buffer, 0, size1, size2);
+    // 2) + 3) LPC analysis + resynthesis, then bit-depth and rate reduction, at the
+    // oversampled rate (both alias)
+    oversampling.process (inputBuffer, [this] (juce::AudioBuffer<float>& block) {
+        lpcEngine.process (block);
+        redux.process (block);
+    });
 
-    if (size1 > 0)
-        circularBuffer.copyFrom(1, start1, buffer, 1, 0, size1);
-    if (size2 > 0)
-        circularBuffer.copyFrom(1, start2, buffer, 1, size1, size2);
+    // A new LPC rate changes the engine's latency once its handover has finished.
+    // setLatencySamples() notifies the host under a lock, so it's left to the message
+    // thread (timerCallback)
+    if (! lpcEngine.isSwitching() && getWetLatencySamples() != getLatencySamples())
+        pendingLatencySamples = getWetLatencySamples();
 
-    fifo.finishedWrite(size1 + size2);
+    // 4) Dry/wet mix and output gain, in one pass
+    mixDry (inputBuffer, false);
+
+    visualizerFifo.pushAudio (inputBuffer);
+
+    for (int ch = 0; ch < inputBuffer.getNumChannels(); ++ch)
+        protectYourEars(inputBuffer.getWritePointer(ch), numSamples);
+
+     #ifdef JUCE_DEBUG
+     if (debugAudioProtection)
+     {
+         for (int ch = 0; ch < inputBuffer.getNumChannels(); ++ch)
+             protectYourEars(inputBuffer.getWritePointer(ch), numSamples);
+     }
+
+     #endif
 }
 
-bool PluginProcessor::FifoQueue::pull(juce::AudioBuffer<float>& buffer)
+void PluginProcessor::pushDry (juce::AudioBuffer<float>& buffer, bool applyInputGain) noexcept
 {
-    int start1, size1, start2, size2;
-    fifo.prepareToRead(buffer.getNumSamples(), start1, size1, start2, size2);
+    auto& gain = paramManager.getInGain();
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin (buffer.getNumChannels(), dryBuffer.getNumChannels());
+    const int capacity = dryBuffer.getNumSamples();
+    const int mask = capacity - 1;
 
-    if (size1 + size2 < buffer.getNumSamples())
-        return false;
+    if (applyInputGain && gain.isSmoothing())
+    {
+        // Ramping: one gain per sample, shared by every channel
+        auto* const* channels = buffer.getArrayOfWritePointers();
+        auto* const* dry = dryBuffer.getArrayOfWritePointers();
 
-    if (size1 > 0)
-        buffer.copyFrom(0, 0, circularBuffer, 0, start1, size1);
-    if (size2 > 0)
-        buffer.copyFrom(0, size1, circularBuffer, 0, start2, size2);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float g = gain.getNextValue();
+            const int position = (dryWritePosition + i) & mask;
 
-    if (size1 > 0)
-        buffer.copyFrom(1, 0, circularBuffer, 1, start1, size1);
-    if (size2 > 0)
-        buffer.copyFrom(1, size1, circularBuffer, 1, start2, size2);
+            for (int ch = 0; ch < numChannels; ++ch)
+                dry[ch][position] = channels[ch][i] *= g;
+        }
+    }
+    else
+    {
+        const float g = applyInputGain ? gain.getTargetValue() : 1.0f;
+        const int first = juce::jmin (numSamples, capacity - dryWritePosition);
 
-    fifo.finishedRead(size1 + size2);
-    return true;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* data = buffer.getWritePointer (ch);
+            float* dry = dryBuffer.getWritePointer (ch);
+
+            for (int i = 0; i < first; ++i)
+                dry[dryWritePosition + i] = data[i] *= g;
+
+            for (int i = first; i < numSamples; ++i)
+                dry[i - first] = data[i] *= g;
+        }
+    }
+
+    dryWritePosition = (dryWritePosition + numSamples) & mask;
 }
 
-void PluginProcessor::processBlock (juce::AudioBuffer<float>& inputBuffer,
-                                    juce::MidiBuffer& midiMessages)
+void PluginProcessor::mixDry (juce::AudioBuffer<float>& buffer, bool bypassed) noexcept
 {
-    // Ignore MIDI messages if not used
-    juce::ignoreUnused(midiMessages);
+    auto& mix = paramManager.getMix();
+    auto& outGain = paramManager.getOutGain();
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin (buffer.getNumChannels(), dryBuffer.getNumChannels());
+    const int capacity = dryBuffer.getNumSamples();
+    const int mask = capacity - 1;
+
+    // The dry samples that line up with this block of wet output. When the wet
+    // latency steps (an engine handover), the read crossfades across the step
+    // over as long as the engines take to
+    const int latency = getWetLatencySamples();
+
+    if (latency != dryLatency)
+    {
+        dryFadeFrom = dryLatency;
+        dryLatency = latency;
+        dryFadePosition = 0;
+        dryFadeLength = juce::jmax (1, lpcEngine.getLatencyStepLength() / oversampling.getFactor());
+    }
 
-    // Update parameters
-    paramManager.updateParameters();
+    const int delay = juce::jmin (latency, capacity - numSamples);
+    jassert (delay == latency); // dry ring sized too small in prepareToPlay
+    const int readPosition = (dryWritePosition - numSamples - delay) & mask;
 
-    // Check for bypass
-    if (paramManager.isBypassed())
+    if (dryFadePosition < dryFadeLength)
     {
-        fifoQueue.push(inputBuffer);
-        return;
-    }
+        const int fromPosition = (dryWritePosition - numSamples - juce::jmin (dryFadeFrom, capacity - numSamples)) & mask;
+        auto* const* channels = buffer.getArrayOfWritePointers();
+        auto* const* dry = dryBuffer.getArrayOfReadPointers();
 
-    lpcProcessor.setPitchDetectionEnabled (paramManager.getPitchDetection());
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float g = bypassed ? 1.0f : outGain.getNextValue();
+            const float m = bypassed ? 0.0f : mix.getNextValue();
+            const float t = juce::jmin (1.0f, ((float) (dryFadePosition + i) + 0.5f) / (float) dryFadeLength);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const float drySample = t * dry[ch][(readPosition + i) & mask] + (1.0f - t) * dry[ch][(fromPosition + i) & mask];
+                channels[ch][i] = g * (m * channels[ch][i] + (1.0f - m) * drySample);
+            }
+        }
 
-    // Prepare a copy of the input buffer to process
-    juce::AudioBuffer<float> processedBuffer;
-    processedBuffer.makeCopyOf(inputBuffer);
+        dryFadePosition += numSamples;
+        return;
+    }
 
+    if (! bypassed && (mix.isSmoothing() || outGain.isSmoothing()))
+    {
+        auto* const* channels = buffer.getArrayOfWritePointers();
+        auto* const* dry = dryBuffer.getArrayOfReadPointers();
 
-    // Apply input gain
-    float inputGain = juce::Decibels::decibelsToGain(paramManager.getInGain());
-    inputBuffer.applyGain(inputGain);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float g = outGain.getNextValue();
+            const float m = mix.getNextValue();
+            const int position = (readPosition + i) & mask;
 
-    // Update LPCProcessor parameters
-    lpcProcessor.setLpcOrder(paramManager.lpcOrder);
-    lpcProcessor.setTargetSampleRate (paramManager.lpcSampleRate);
+            for (int ch = 0; ch < numChannels; ++ch)
+                channels[ch][i] = g * (m * channels[ch][i] + (1.0f - m) * dry[ch][position]);
+        }
 
-    // Apply LPC processing
-    // lpcProcessor.process(inputBuffer, processedBuffer);
+        return;
+    }
 
-    float outputGain = juce::Decibels::decibelsToGain(paramManager.getOutGain());
-    processedBuffer.applyGain(outputGain);
+    // Steady gains: out = wetGain * wet + dryGain * dry
+    const float wetGain = bypassed ? 0.0f : outGain.getTargetValue() * mix.getTargetValue();
+    const float dryGain = bypassed ? 1.0f : outGain.getTargetValue() * (1.0f - mix.getTargetValue());
+    const int first = juce::jmin (numSamples, capacity - readPosition);
 
-    // copy to original for output, send to visualizer
-    inputBuffer.makeCopyOf(processedBuffer);
-    fifoQueue.push(inputBuffer);
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* data = buffer.getWritePointer (ch);
+        const float* dry = dryBuffer.getReadPointer (ch);
 
-    protectYourEars(inputBuffer.getWritePointer(0), inputBuffer.getNumSamples());
-    protectYourEars(inputBuffer.getWritePointer(1), inputBuffer.getNumSamples());
+        for (int i = 0; i < first; ++i)
+            data[i] = wetGain * data[i] + dryGain * dry[readPosition + i];
 
-     #ifdef JUCE_DEBUG
-     if (debugAudioProtection)
-     {
-         protectYourEars(inputBuffer.getWritePointer(0), inputBuffer.getNumSamples());
-         protectYourEars(inputBuffer.getWritePointer(1), inputBuffer.getNumSamples());
-     }
-    
-     #endif
+        for (int i = first; i < numSamples; ++i)
+            data[i] = wetGain * data[i] + dryGain * dry[i - first];
+    }
 }
 
 
@@ -249,49 +460,6 @@ void PluginProcessor::setStateInformation (const void* data, int sizeInBytes)
 }
 
 
-/*
-     Resamples an audio buffer to a target sample rate using linear interpolation
-
-     juce::AudioBuffer<float> inputBuffer -> The input audio buffer
-     int targetSampleRate -> the target sample rate in samples (e.g. 44_100 represents 44.1kHz)
-     returns -> juce::AudioBuffer<float> resampledBuffer (which is at the target sample rate)
-*/
-juce::AudioBuffer<float> PluginProcessor::resampleBuffer (const juce::AudioBuffer<float>& inputBuffer, const int targetSampleRate)
-{
-    const int numSamples = inputBuffer.getNumSamples();
-    const int numChannels = inputBuffer.getNumChannels();
-    const double resamplingFactor = static_cast<double> (numSamples) / targetSampleRate;
-
-    // represents the expected number of samples for the new buffer, since lower samples rates have fewer samples in the same amount of time
-    // think: hertz (Hz) -> samples / second, we cant change the length of audio so we change how densely the samples are spread
-
-    const int resampledNumSamples = static_cast<int> (numSamples * resamplingFactor);
-    juce::AudioBuffer<float> resampledBuffer (numChannels, resampledNumSamples);
-
-    // main loop
-    for (int channel = 0; channel < numChannels; ++channel)
-    {
-        const float* input = inputBuffer.getReadPointer (channel);
-        float* resampled = resampledBuffer.getWritePointer (channel);
-
-        // Resampling using linear interpolation
-        for (int i = 0; i < resampledNumSamples; ++i)
-        {
-            const float inputPosition = static_cast<double>(i) / resamplingFactor;
-            const int pos0 = static_cast<int> (std::floor (inputPosition));
-            const int pos1 = std::min (pos0 + 1, numSamples - 1);
-            const float frac = inputPosition - static_cast<float>(pos0);
-
-            resampled[i] = input[pos0] + frac * (input[pos1] - input[pos0]);
-        }
-    }
-    return resampledBuffer;
-}
-
-
-
-
-
 //==============================================================================
 // This creates new instances of the plugin..
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
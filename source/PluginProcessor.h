@@ -1,34 +1,27 @@
 #pragma once
 
-#include "LPCProcessor.h"
+#include "LPCEngineManager.h"
+#include "OversamplingStage.h"
 #include "ParameterManager.h"
+#include "ReduxProcessor.h"
+#include "VisualizerFifo.h"
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
+#include <atomic>
 
 #if (MSVC)
 #include "ipps.h"
 #endif
 
-class PluginProcessor : public juce::AudioProcessor
+class PluginProcessor : public juce::AudioProcessor,
+                        private juce::Timer
 {
 public:
     PluginProcessor();
     ~PluginProcessor() override;
 
-    // FIFO for audio visualization
-    class FifoQueue
-    {
-    public:
-        void push(const juce::AudioBuffer<float>& buffer);
-        bool pull(juce::AudioBuffer<float>& buffer);
-
-    private:
-        static constexpr int bufferSize = 48000; // 1 second buffer at 48kHz
-        juce::AbstractFifo fifo { bufferSize };
-        juce::AudioBuffer<float> circularBuffer { 2, bufferSize };
-    };
-
-    FifoQueue fifoQueue;
+    // Mid/side transport to the visualizer (idle while no editor is attached)
+    VisualizerFifo visualizerFifo;
 
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
@@ -56,10 +49,14 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
-    static juce::AudioBuffer<float> resampleBuffer(const juce::AudioBuffer<float>& inputBuffer, int targetSampleRate);
-
     juce::AudioProcessorValueTreeState apvts;
 
+    /** The LPC engine switcher (read only), so tests can follow an engine handover. */
+    const LPCEngineManager& getLPCEngineManager() const noexcept { return lpcEngine; }
+
+    /** The top of REDUX_RATE's range (and its default), which turns rate reduction off. */
+    static constexpr float maxReduxRate = 96000.0f;
+
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout()
     {
         /*
@@ -69,8 +66,17 @@ public:
         - In / Out Gain
         - Bypass
 
+        Redux Settings
+        - Bit Depth / Rate
+        - Dither, Noise Shaping, Anti-Aliasing
+
+        Oversampling Settings
+        - Realtime / Offline Factor
+        - Linear Phase Filters
+
         Visualizer Settings
         - Visualizer Smoothing Value
+        - Analyzer FFT Size / Overlap
 
         */
 
@@ -89,21 +95,69 @@ public:
         params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"LPC_ALPHA", 1}, "LPC Alpha", 0.01f, 1.0f, 0.95f));
         params.push_back(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{"PITCH_DETECTION", 1}, "Enable Pitch Detection", false));
 
+        // Redux settings (the defaults leave the signal untouched)
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"BIT_DEPTH", 1}, "Bit Depth", 1.0f, 24.0f, 24.0f));
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"REDUX_RATE", 1}, "Redux Rate", 1000.0f, maxReduxRate, maxReduxRate));
+        params.push_back(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{"DITHER", 1}, "Dither", false));
+        params.push_back(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{"NOISE_SHAPING", 1}, "Noise Shaping", false));
+        params.push_back(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{"REDUX_ANTI_ALIAS", 1}, "Redux Anti-Aliasing", true));
+
+        // Oversampling settings (around the LPC + redux chain, applied in prepareToPlay)
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"OVERSAMPLING", 1}, "Oversampling", juce::StringArray { "1x", "2x", "4x", "8x" }, 0));
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"OVERSAMPLING_OFFLINE", 1}, "Offline Oversampling", juce::StringArray { "Same as Realtime", "1x", "2x", "4x", "8x" }, 0));
+        params.push_back(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{"OVERSAMPLING_LINEAR_PHASE", 1}, "Linear Phase Oversampling", false));
+
         // Visualizer settings
         params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{"VIS_SMOOTH", 1}, "Visualizer Smoothing Value", 0.0f, 1.0f, 0.69f));
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"VIS_FFT_SIZE", 1}, "Analyzer FFT Size", juce::StringArray { "512", "1024", "2048", "4096", "8192" }, 2));
+        params.push_back(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{"VIS_OVERLAP", 1}, "Analyzer Overlap", juce::StringArray { "50%", "75%" }, 0));
 
         return { params.begin(), params.end() };
     }
 
 private:
 
-    LPCProcessor lpcProcessor;
+    // The effect chain, run at the oversampled rate
+    OversamplingStage oversampling;
+    LPCEngineManager lpcEngine;
+    ReduxProcessor redux;
 
-    ParameterManager paramManager;
+    /** The oversampling order wanted for the parameters and the current render mode. */
+    int oversamplingOrderFor (const ParameterManager::Snapshot& params) const noexcept;
+
+    /** Latency of the whole wet path (oversampling filters + LPC engine), in host samples. */
+    int getWetLatencySamples() const noexcept;
+
+    /** Set by the audio thread when the oversampling settings no longer match the
+        prepared ones; the timer then re-prepares from the message thread.
+    */
+    std::atomic<bool> oversamplingChangePending { false };
+
+    /** Set by the audio thread to the wet path's settled latency when it no longer matches
+        the reported one (-1: nothing to report); the timer then calls setLatencySamples()
+        from the message thread.
+    */
+    std::atomic<int> pendingLatencySamples { -1 };
+    void timerCallback() override;
+
+    /** Pushes the redux parameters into the redux stage (cheap, audio thread safe). */
+    void updateRedux (const ParameterManager::Snapshot& params) noexcept;
 
-    // visualiser
-    juce::AudioBuffer<float> midBuffer;
-    juce::AudioBuffer<float> sideBuffer;
+    // Dry path, read back delayed by the wet path's latency:
+    juce::AudioBuffer<float> dryBuffer; ///< one ring per channel (power-of-two length).
+    int dryWritePosition = 0;
+    int dryLatency = 0; ///< the delay the dry ring is read at.
+    int dryFadeFrom = 0, dryFadePosition = 0, dryFadeLength = 0; ///< crossfading the read from dryFadeFrom.
+
+    /** Applies the (ramped) input gain in place, writing the result into the dry ring too. */
+    void pushDry (juce::AudioBuffer<float>& buffer, bool applyInputGain) noexcept;
+
+    /** Mixes the delayed dry signal with the wet buffer and applies the output gain, in one pass.
+        While bypassed it outputs the delayed dry signal alone.
+    */
+    void mixDry (juce::AudioBuffer<float>& buffer, bool bypassed) noexcept;
+
+    ParameterManager paramManager;
 
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginProcessor)
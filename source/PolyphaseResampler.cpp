@@ -0,0 +1,255 @@
+#include "PolyphaseResampler.h"
+#include "SIMDKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+//==============================================================================
+int PolyphaseResampler::getBaseTapsPerPhase (Quality q) noexcept
+{
+    switch (q)
+    {
+        case Quality::low:
+            return 16;
+        case Quality::high:
+            return 64;
+        case Quality::medium:
+        default:
+            return 32;
+    }
+}
+
+int PolyphaseResampler::computeTapsPerPhase (int upFactor, int downFactor, Quality q) noexcept
+{
+    const int decimation = (downFactor + upFactor - 1) / upFactor;
+    return getBaseTapsPerPhase (q) * juce::jmax (1, decimation);
+}
+
+//==============================================================================
+void PolyphaseResampler::prepare (int numChannels, int newMaxInputSamples, int maxUpFactor, int maxDownFactor, Quality newQuality)
+{
+    quality = newQuality;
+    maxInputSamples = juce::jmax (1, newMaxInputSamples);
+    maxUpFactor = juce::jmax (1, maxUpFactor);
+    maxDownFactor = juce::jmax (1, maxDownFactor);
+
+    // Worst case over every ratio p / q with p <= maxUpFactor and q <= maxDownFactor
+    const int maxTaps = computeTapsPerPhase (1, maxDownFactor, quality);
+    size_t maxCoefficients = 0;
+
+    for (int p = 1; p <= maxUpFactor; ++p)
+        maxCoefficients = std::max (maxCoefficients, (size_t) p * (size_t) computeTapsPerPhase (p, maxDownFactor, quality));
+
+    coefficients.reserve (maxCoefficients);
+
+    histories.resize ((size_t) juce::jmax (0, numChannels));
+    for (auto& history : histories)
+        history.reserve ((size_t) (maxTaps - 1 + maxInputSamples));
+
+    up = down = 0; // force a redesign
+    setRatio (1, 1);
+}
+
+void PolyphaseResampler::setRatio (int upFactor, int downFactor)
+{
+    upFactor = juce::jmax (1, upFactor);
+    downFactor = juce::jmax (1, downFactor);
+
+    const int divisor = std::gcd (upFactor, downFactor);
+    upFactor /= divisor;
+    downFactor /= divisor;
+
+    if (upFactor == up && downFactor == down)
+        return;
+
+    up = upFactor;
+    down = downFactor;
+    tapsPerPhase = computeTapsPerPhase (up, down, quality);
+
+    // Within the capacity reserved by prepare() these resizes never reallocate
+    jassert ((size_t) up * (size_t) tapsPerPhase <= coefficients.capacity());
+    coefficients.resize ((size_t) up * (size_t) tapsPerPhase);
+
+    for (auto& history : histories)
+    {
+        jassert ((size_t) (tapsPerPhase - 1 + maxInputSamples) <= history.capacity());
+        history.resize ((size_t) (tapsPerPhase - 1 + maxInputSamples));
+    }
+
+    designFilter();
+    reset();
+}
+
+void PolyphaseResampler::reset() noexcept
+{
+    for (auto& history : histories)
+        std::fill (history.begin(), history.end(), 0.0f);
+
+    timeNumerator = 0;
+}
+
+//==============================================================================
+double PolyphaseResampler::besselI0 (double x) noexcept
+{
+    // Power series, converges quickly for the beta values used here
+    double sum = 1.0, term = 1.0;
+    const double halfX = 0.5 * x;
+
+    for (int k = 1; k < 50 && term > 1.0e-12 * sum; ++k)
+    {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+    }
+
+    return sum;
+}
+
+void PolyphaseResampler::designFilter() noexcept
+{
+    // Prototype at the upsampled rate: length tapsPerPhase * up, cutoff just below
+    // the lower of the two Nyquist frequencies
+    const double beta = quality == Quality::low ? 5.0 : (quality == Quality::high ? 10.0 : 8.0);
+    const double passband = quality == Quality::low ? 0.85 : (quality == Quality::high ? 0.95 : 0.9);
+
+    const int length = tapsPerPhase * up;
+    const double cutoff = passband * 0.5 / (double) juce::jmax (up, down); // cycles per upsampled sample
+    const double centre = 0.5 * (double) (length - 1);
+    const double i0Beta = besselI0 (beta);
+
+    for (int n = 0; n < length; ++n)
+    {
+        const double t = (double) n - centre;
+        const double sinc = t == 0.0 ? 2.0 * cutoff
+                                     : std::sin (2.0 * juce::MathConstants<double>::pi * cutoff * t) / (juce::MathConstants<double>::pi * t);
+
+        const double ratio = t / centre;
+        const double window = centre > 0.0 ? besselI0 (beta * std::sqrt (juce::jmax (0.0, 1.0 - ratio * ratio))) / i0Beta : 1.0;
+
+        // Tap n belongs to phase n % up at position n / up; rows are stored reversed so
+        // output = dot (row, history[base .. base + tapsPerPhase)). The gain of 'up'
+        // makes up for the zero-stuffing.
+        const int phase = n % up;
+        const int k = n / up;
+        coefficients[(size_t) phase * (size_t) tapsPerPhase + (size_t) (tapsPerPhase - 1 - k)] = (float) (sinc * window * up);
+    }
+}
+
+//==============================================================================
+int PolyphaseResampler::getMaxOutputSamples (int numInput) const noexcept
+{
+    return (int) (((long long) numInput * up) / down) + 1;
+}
+
+double PolyphaseResampler::getLatencyInInputSamples() const noexcept
+{
+    return 0.5 * (double) (tapsPerPhase * up - 1) / (double) up;
+}
+
+double PolyphaseResampler::getLatencyInInputSamples (int upFactor, int downFactor, Quality q) noexcept
+{
+    upFactor = juce::jmax (1, upFactor);
+    downFactor = juce::jmax (1, downFactor);
+
+    const int divisor = std::gcd (upFactor, downFactor);
+    upFactor /= divisor;
+    downFactor /= divisor;
+
+    return 0.5 * (double) (computeTapsPerPhase (upFactor, downFactor, q) * upFactor - 1) / (double) upFactor;
+}
+
+int PolyphaseResampler::process (const float* const* input, int numInput, float* const* output) noexcept
+{
+    jassert (numInput <= maxInputSamples);
+    numInput = juce::jmin (numInput, maxInputSamples);
+
+    const int historyLength = tapsPerPhase - 1;
+    int numOutput = 0;
+
+    for (size_t ch = 0; ch < histories.size(); ++ch)
+    {
+        auto& history = histories[ch];
+        std::copy_n (input[ch], numInput, history.begin() + historyLength);
+
+        const float* samples = history.data();
+        float* dest = output[ch];
+        long long time = timeNumerator;
+        int n = 0;
+
+        // Output at input position time / up uses input samples
+        // [base - tapsPerPhase + 1, base], i.e. history[base .. base + tapsPerPhase)
+        for (; time < (long long) numInput * up; time += down)
+        {
+            const auto base = (int) (time / up);
+            const auto phase = (int) (time % up);
+
+            dest[n++] = SIMDKernels::dotProduct (coefficients.data() + (size_t) phase * (size_t) tapsPerPhase,
+                samples + base,
+                tapsPerPhase);
+        }
+
+        // Keep the last tapsPerPhase - 1 samples for the next block
+        std::copy_n (history.begin() + numInput, historyLength, history.begin());
+        numOutput = n;
+    }
+
+    // Advance the read position past this block (same for every channel)
+    while (timeNumerator < (long long) numInput * up)
+        timeNumerator += down;
+
+    timeNumerator -= (long long) numInput * up;
+    return numOutput;
+}
+
+//==============================================================================
+void PolyphaseResampler::approximateRatio (double inRate, double outRate, int maxUpFactor, int& upFactor, int& downFactor) noexcept
+{
+    upFactor = downFactor = 1;
+
+    if (inRate <= 0.0 || outRate <= 0.0)
+        return;
+
+    // Exact for integer rates whose reduced ratio fits
+    const auto inInt = (long long) std::llround (inRate);
+    const auto outInt = (long long) std::llround (outRate);
+
+    if (std::abs (inRate - (double) inInt) < 1.0e-9 && std::abs (outRate - (double) outInt) < 1.0e-9)
+    {
+        const auto divisor = std::gcd (inInt, outInt);
+
+        if (outInt / divisor <= maxUpFactor)
+        {
+            upFactor = (int) (outInt / divisor);
+            downFactor = (int) (inInt / divisor);
+            return;
+        }
+    }
+
+    // Otherwise walk the continued fraction of outRate / inRate until the numerator gets too big
+    double x = outRate / inRate;
+    long long p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+
+    for (int i = 0; i < 32; ++i)
+    {
+        const auto a = (long long) std::floor (x);
+        const long long p2 = a * p1 + p0;
+        const long long q2 = a * q1 + q0;
+
+        if (p2 > maxUpFactor || q2 > (1LL << 30))
+            break;
+
+        p0 = p1, q0 = q1, p1 = p2, q1 = q2;
+
+        const double fraction = x - (double) a;
+        if (fraction < 1.0e-12)
+            break;
+
+        x = 1.0 / fraction;
+    }
+
+    if (p1 > 0 && q1 > 0)
+    {
+        upFactor = (int) p1;
+        downFactor = (int) q1;
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <vector>
+
+/**
+    Streaming rational-ratio resampler (polyphase windowed sinc).
+
+    Converts by upFactor / downFactor: conceptually the input is zero-stuffed by
+    upFactor, low-passed by a Kaiser-windowed sinc, and every downFactor-th
+    sample is kept. Only the outputs that are kept are computed, each one as a
+    single SIMD dot product between one phase of the prototype filter and the
+    input history, so the cost is (taps per phase) multiply-adds per output
+    sample.
+
+    The filter history and the fractional read position are carried across
+    calls, so consecutive blocks join seamlessly and the number of samples
+    produced depends only on the ratio, not on how the input is sliced.
+
+    prepare() reserves storage for the largest ratio that will be used;
+    setRatio() then redesigns the filter in place without allocating, and
+    process() writes into caller-provided buffers.
+*/
+class PolyphaseResampler
+{
+public:
+    enum class Quality
+    {
+        low, ///< 16 taps per phase, ~50 dB stopband
+        medium, ///< 32 taps per phase, ~80 dB stopband
+        high ///< 64 taps per phase, ~100 dB stopband
+    };
+
+    PolyphaseResampler() = default;
+
+    //==========================================================================
+    /** Allocates for up to maxUpFactor / maxDownFactor ratios and blocks of up to
+        maxInputSamples. Must be called off the audio thread.
+    */
+    void prepare (int numChannels, int maxInputSamples, int maxUpFactor, int maxDownFactor, Quality quality);
+
+    /** Sets the conversion ratio (reduced internally) and clears the history.
+        Does not allocate as long as the ratio fits what prepare() reserved.
+    */
+    void setRatio (int upFactor, int downFactor);
+
+    /** Clears the filter history and read position. */
+    void reset() noexcept;
+
+    //==========================================================================
+    /** Resamples numInput samples per channel. Returns the number of samples
+        written to each output channel, at most getMaxOutputSamples (numInput).
+    */
+    int process (const float* const* input, int numInput, float* const* output) noexcept;
+
+    /** Upper bound on the samples process() can produce from numInput samples. */
+    int getMaxOutputSamples (int numInput) const noexcept;
+
+    /** Group delay of the anti-aliasing filter, in input samples. */
+    double getLatencyInInputSamples() const noexcept;
+
+    /** The group delay a resampler would have for a ratio, without preparing one. */
+    static double getLatencyInInputSamples (int upFactor, int downFactor, Quality quality) noexcept;
+
+    int getUpFactor() const noexcept { return up; }
+    int getDownFactor() const noexcept { return down; }
+    int getTapsPerPhase() const noexcept { return tapsPerPhase; }
+    Quality getQuality() const noexcept { return quality; }
+
+    //==========================================================================
+    /** Best approximation p / q of outRate / inRate with p <= maxUpFactor
+        (continued fractions). Returns exact ratios like 1/6 or 1/4 as-is.
+    */
+    static void approximateRatio (double inRate, double outRate, int maxUpFactor, int& upFactor, int& downFactor) noexcept;
+
+    static int getBaseTapsPerPhase (Quality quality) noexcept;
+
+private:
+    //==========================================================================
+    /** Taps per phase grow with the decimation ratio, so the transition band keeps its width. */
+    static int computeTapsPerPhase (int upFactor, int downFactor, Quality quality) noexcept;
+
+    /** Fills the per-phase coefficient rows for the current ratio. */
+    void designFilter() noexcept;
+
+    static double besselI0 (double x) noexcept;
+
+    Quality quality = Quality::medium;
+    int up = 1, down = 1;
+    int tapsPerPhase = 0;
+    int maxInputSamples = 0;
+
+    /** Read position within the current block, in units of 1 / up input samples. */
+    long long timeNumerator = 0;
+
+    /** up rows of tapsPerPhase coefficients, each reversed for the dot product. */
+    std::vector<float> coefficients;
+
+    /** Per channel: tapsPerPhase - 1 samples of history followed by the current block. */
+    std::vector<std::vector<float>> histories;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PolyphaseResampler)
+};
@@ -7,6 +7,30 @@
 #pragma once
 
 #include <juce_core/juce_core.h>
+#include <atomic>
+
+// What protectYourEars() ran into. It runs on the audio thread, where DBG isn't
+// allowed (it allocates and locks), so it only raises these flags; call
+// logProtectYourEarsWarnings() from the message thread to print them.
+enum ProtectYourEarsWarning
+{
+    nanWarning = 1 << 0,
+    infWarning = 1 << 1,
+    screamingWarning = 1 << 2,
+    clampWarning = 1 << 3
+};
+
+inline std::atomic<int> protectYourEarsWarnings { 0 };
+
+inline void logProtectYourEarsWarnings()
+{
+    const int warnings = protectYourEarsWarnings.exchange(0, std::memory_order_relaxed);
+    if (warnings & nanWarning) { DBG("!!! WARNING: nan detected in audio buffer, silencing !!!"); }
+    if (warnings & infWarning) { DBG("!!! WARNING: inf detected in audio buffer, silencing !!!"); }
+    if (warnings & screamingWarning) { DBG("!!! WARNING: sample out of range, silencing !!!"); }
+    if (warnings & clampWarning) { DBG("!!! WARNING: sample out of range, clamping !!!"); }
+    juce::ignoreUnused(warnings);
+}
 
 inline void protectYourEars(float* buffer, int sampleCount)
 {
@@ -16,23 +40,23 @@ inline void protectYourEars(float* buffer, int sampleCount)
         float x = buffer[i];
         bool silence = false;
         if (std::isnan(x)) {
-            DBG("!!! WARNING: nan detected in audio buffer, silencing !!!");
+            protectYourEarsWarnings.fetch_or(nanWarning, std::memory_order_relaxed);
             silence = true;
         } else if (std::isinf(x)) {
-            DBG("!!! WARNING: inf detected in audio buffer, silencing !!!");
+            protectYourEarsWarnings.fetch_or(infWarning, std::memory_order_relaxed);
             silence = true;
         } else if (x < -2.0f || x > 2.0f) {  // screaming feedback
-            DBG("!!! WARNING: sample out of range, silencing !!!");
+            protectYourEarsWarnings.fetch_or(screamingWarning, std::memory_order_relaxed);
             silence = true;
         } else if (x < -1.0f) {
             if (firstWarning) {
-                DBG("!!! WARNING: sample out of range, clamping !!!");
+                protectYourEarsWarnings.fetch_or(clampWarning, std::memory_order_relaxed);
                 firstWarning = false;
             }
             buffer[i] = -1.0f;
         } else if (x > 1.0f) {
             if (firstWarning) {
-                DBG("!!! WARNING: sample out of range, clamping !!!");
+                protectYourEarsWarnings.fetch_or(clampWarning, std::memory_order_relaxed);
                 firstWarning = false;
             }
             buffer[i] = 1.0f;
@@ -0,0 +1,378 @@
+#include "ReduxProcessor.h"
+#include "SIMDKernels.h"
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <cmath>
+#include <complex>
+
+// An AVX2 + FMA quantizer is compiled into x86 builds that don't already target
+// AVX, and picked at runtime when the CPU supports it
+#if ! BYTEMARK_SIMD_AVX && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64))
+    #include <immintrin.h>
+    #define BYTEMARK_RUNTIME_AVX2 1
+
+    #if defined(__GNUC__) || defined(__clang__)
+        #define BYTEMARK_TARGET_AVX2 __attribute__ ((target ("avx2,fma")))
+    #else
+        #define BYTEMARK_TARGET_AVX2
+    #endif
+#endif
+
+namespace
+{
+    //==========================================================================
+    // Quantizers: data[i] = step * round (data[i] * inverseStep + dither[i]),
+    // rounding to nearest-even in every path. dither may be null.
+
+    void quantizeBlock (float* data, int numSamples, float step, float inverseStep, const float* dither) noexcept
+    {
+        int i = 0;
+
+#if BYTEMARK_SIMD_AVX
+        const __m256 stepVec = _mm256_set1_ps (step);
+        const __m256 inverseVec = _mm256_set1_ps (inverseStep);
+
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            __m256 v = _mm256_mul_ps (_mm256_loadu_ps (data + i), inverseVec);
+
+            if (dither != nullptr)
+                v = _mm256_add_ps (v, _mm256_loadu_ps (dither + i));
+
+            v = _mm256_round_ps (v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            _mm256_storeu_ps (data + i, _mm256_mul_ps (v, stepVec));
+        }
+#elif BYTEMARK_SIMD_SSE
+        const __m128 stepVec = _mm_set1_ps (step);
+        const __m128 inverseVec = _mm_set1_ps (inverseStep);
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            __m128 v = _mm_mul_ps (_mm_loadu_ps (data + i), inverseVec);
+
+            if (dither != nullptr)
+                v = _mm_add_ps (v, _mm_loadu_ps (dither + i));
+
+            // cvtps rounds to nearest-even under the default MXCSR mode
+            v = _mm_cvtepi32_ps (_mm_cvtps_epi32 (v));
+            _mm_storeu_ps (data + i, _mm_mul_ps (v, stepVec));
+        }
+#elif BYTEMARK_SIMD_NEON && (defined(__aarch64__) || defined(_M_ARM64))
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            float32x4_t v = vmulq_n_f32 (vld1q_f32 (data + i), inverseStep);
+
+            if (dither != nullptr)
+                v = vaddq_f32 (v, vld1q_f32 (dither + i));
+
+            vst1q_f32 (data + i, vmulq_n_f32 (vrndnq_f32 (v), step));
+        }
+#endif
+
+        for (; i < numSamples; ++i)
+            data[i] = step * std::nearbyint (data[i] * inverseStep + (dither != nullptr ? dither[i] : 0.0f));
+    }
+
+#if BYTEMARK_RUNTIME_AVX2
+    BYTEMARK_TARGET_AVX2 void quantizeBlockAVX2 (float* data, int numSamples, float step, float inverseStep, const float* dither) noexcept
+    {
+        const __m256 stepVec = _mm256_set1_ps (step);
+        const __m256 inverseVec = _mm256_set1_ps (inverseStep);
+        int i = 0;
+
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            const __m256 offset = dither != nullptr ? _mm256_loadu_ps (dither + i) : _mm256_setzero_ps();
+            const __m256 v = _mm256_fmadd_ps (_mm256_loadu_ps (data + i), inverseVec, offset);
+            _mm256_storeu_ps (data + i, _mm256_mul_ps (_mm256_round_ps (v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC), stepVec));
+        }
+
+        quantizeBlock (data + i, numSamples - i, step, inverseStep, dither != nullptr ? dither + i : nullptr);
+    }
+#endif
+
+    //==========================================================================
+    constexpr int blepPhases = 32; ///< fractional step positions per sample.
+
+    /** Minimum-phase band-limited step (Brandt's minBLEP) minus the ideal step,
+        tabulated for blepPhases + 1 fractional offsets (the extra row is for interpolation).
+    */
+    struct MinBlepTable
+    {
+        MinBlepTable()
+        {
+            constexpr int length = ReduxProcessor::blepLength * blepPhases;
+            constexpr int fftOrder = 12;
+            constexpr int fftSize = 1 << fftOrder;
+            constexpr double pi = juce::MathConstants<double>::pi;
+            constexpr double cutoff = 0.9; ///< relative to the host Nyquist frequency.
+
+            juce::dsp::FFT fft (fftOrder);
+            std::vector<std::complex<float>> a ((size_t) fftSize), b ((size_t) fftSize);
+
+            // 1) Blackman-windowed sinc (linear phase), oversampled by blepPhases
+            for (int i = 0; i <= length; ++i)
+            {
+                const double t = cutoff * (double) (i - length / 2) / (double) blepPhases;
+                const double sinc = t == 0.0 ? 1.0 : std::sin (pi * t) / (pi * t);
+                const double window = 0.42 - 0.5 * std::cos (2.0 * pi * i / length) + 0.08 * std::cos (4.0 * pi * i / length);
+                a[(size_t) i] = (float) (sinc * window);
+            }
+
+            // 2) Real cepstrum: inverse transform of the log magnitude
+            fft.perform (a.data(), b.data(), false);
+
+            for (auto& bin : b)
+                bin = std::log (std::max (std::abs (bin), 1.0e-7f));
+
+            fft.perform (b.data(), a.data(), true);
+
+            // 3) Fold it onto the positive quefrencies, which makes the phase minimal
+            for (int n = 1; n < fftSize / 2; ++n)
+                a[(size_t) n] = 2.0f * a[(size_t) n].real();
+
+            a[0] = a[0].real();
+            a[fftSize / 2] = a[fftSize / 2].real();
+            std::fill (a.begin() + fftSize / 2 + 1, a.end(), 0.0f);
+
+            fft.perform (a.data(), b.data(), false);
+
+            for (auto& bin : b)
+                bin = std::exp (bin);
+
+            fft.perform (b.data(), a.data(), true);
+
+            // 4) Integrate the minimum-phase impulse into a step that settles at 1
+            std::vector<float> step ((size_t) length);
+            float sum = 0.0f;
+
+            for (int i = 0; i < length; ++i)
+                step[(size_t) i] = (sum += a[(size_t) i].real());
+
+            for (auto& value : step)
+                value /= sum;
+
+            // 5) Residual of step[t * blepPhases] - 1, row p holding t = k + p / blepPhases
+            for (int p = 0; p <= blepPhases; ++p)
+                for (int k = 0; k < ReduxProcessor::blepLength; ++k)
+                {
+                    const int j = k * blepPhases + p;
+                    residual[(size_t) (p * ReduxProcessor::blepLength + k)] = j < length ? step[(size_t) j] - 1.0f : 0.0f;
+                }
+        }
+
+        std::array<float, (size_t) (blepPhases + 1) * ReduxProcessor::blepLength> residual {};
+    };
+
+    const MinBlepTable& getMinBlepTable()
+    {
+        static const MinBlepTable table;
+        return table;
+    }
+
+    constexpr int ditherBlockSize = 256; ///< dither noise is generated in chunks of this size.
+}
+
+//==============================================================================
+ReduxProcessor::ReduxProcessor()
+{
+    quantizeKernel = quantizeBlock;
+
+#if BYTEMARK_RUNTIME_AVX2
+    if (hasAVX2Quantizer())
+        quantizeKernel = quantizeBlockAVX2;
+#endif
+
+    getMinBlepTable(); // built once, here rather than on the audio thread
+    setBitDepth (maxBitDepth);
+}
+
+void ReduxProcessor::prepare (double newSampleRate, int numChannels)
+{
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+    channels.resize ((size_t) juce::jmax (0, numChannels));
+
+    for (size_t ch = 0; ch < channels.size(); ++ch)
+    {
+        channels[ch].ditherSeeds[0] = SIMDKernels::hashNoise (0x7e0du, (uint32_t) (2 * ch));
+        channels[ch].ditherSeeds[1] = SIMDKernels::hashNoise (0x7e0du, (uint32_t) (2 * ch + 1));
+    }
+
+    setTargetSampleRate (targetSampleRate);
+    reset();
+}
+
+void ReduxProcessor::reset() noexcept
+{
+    for (auto& state : channels)
+    {
+        state.held = state.previousInput = state.shapingError = 0.0f;
+        state.blep.fill (0.0f);
+        state.blepPosition = 0;
+    }
+
+    holdPhase = 0.0;
+    ditherIndex = 0;
+}
+
+void ReduxProcessor::setBitDepth (float newBitDepth) noexcept
+{
+    bitDepth = juce::jlimit (minBitDepth, maxBitDepth, newBitDepth);
+    step = std::exp2 (1.0f - bitDepth);
+}
+
+void ReduxProcessor::setTargetSampleRate (double newRate) noexcept
+{
+    targetSampleRate = newRate;
+    holdIncrement = newRate > 0.0 && newRate < sampleRate ? newRate / sampleRate : 1.0;
+}
+
+//==============================================================================
+void ReduxProcessor::process (juce::AudioBuffer<float>& buffer) noexcept
+{
+    const int numChannels = juce::jmin (buffer.getNumChannels(), (int) channels.size());
+    const int numSamples = buffer.getNumSamples();
+
+    // Rate first, so the quantizer sees the held (and band-limited) signal
+    if (holdIncrement < 1.0)
+    {
+        double endPhase = holdPhase;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            endPhase = holdSamples (channels[(size_t) ch], buffer.getWritePointer (ch), numSamples, holdPhase);
+
+        holdPhase = endPhase;
+    }
+
+    if (bitDepth < maxBitDepth)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            quantize (channels[(size_t) ch], buffer.getWritePointer (ch), numSamples);
+
+        ditherIndex += (uint32_t) numSamples;
+    }
+}
+
+double ReduxProcessor::holdSamples (ChannelState& state, float* data, int numSamples, double phase) const noexcept
+{
+    constexpr int mask = blepLength - 1;
+    static_assert ((blepLength & mask) == 0, "the BLEP ring is indexed with a mask");
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        const float input = data[n];
+        phase += holdIncrement;
+
+        if (phase >= 1.0)
+        {
+            // The hold clock ticked 'fraction' samples before this one: take the input
+            // at that exact time, and (optionally) start the step there too
+            phase -= 1.0;
+            const auto fraction = (float) (phase / holdIncrement);
+            const float value = input + fraction * (state.previousInput - input);
+
+            if (antiAliasingEnabled)
+                addBlep (state, value - state.held, fraction);
+
+            state.held = value;
+        }
+
+        state.previousInput = input;
+
+        float& correction = state.blep[(size_t) state.blepPosition];
+        data[n] = state.held + correction;
+        correction = 0.0f;
+        state.blepPosition = (state.blepPosition + 1) & mask;
+    }
+
+    return phase;
+}
+
+void ReduxProcessor::addBlep (ChannelState& state, float delta, float fraction) noexcept
+{
+    const auto& residual = getMinBlepTable().residual;
+
+    const float position = juce::jlimit (0.0f, (float) blepPhases, fraction * (float) blepPhases);
+    const int row = juce::jmin ((int) position, blepPhases - 1);
+    const float weight = position - (float) row;
+
+    const float* lower = residual.data() + row * blepLength;
+    const float* upper = lower + blepLength;
+
+    for (int k = 0; k < blepLength; ++k)
+    {
+        const float value = lower[k] + weight * (upper[k] - lower[k]);
+        state.blep[(size_t) ((state.blepPosition + k) & (blepLength - 1))] += delta * value;
+    }
+}
+
+void ReduxProcessor::quantize (ChannelState& state, float* data, int numSamples) const noexcept
+{
+    const float inverseStep = 1.0f / step;
+    std::array<float, ditherBlockSize> dither, second;
+
+    for (int start = 0; start < numSamples; start += ditherBlockSize)
+    {
+        const int count = juce::jmin (ditherBlockSize, numSamples - start);
+        float* block = data + start;
+
+        // TPDF dither: the difference of two uniform streams, +-1 LSB peak
+        if (ditherEnabled)
+        {
+            const auto index = ditherIndex + (uint32_t) start;
+            SIMDKernels::fillUniformNoise (dither.data(), count, state.ditherSeeds[0], index);
+            SIMDKernels::fillUniformNoise (second.data(), count, state.ditherSeeds[1], index);
+            juce::FloatVectorOperations::subtract (dither.data(), second.data(), count);
+            juce::FloatVectorOperations::multiply (dither.data(), 0.5f, count);
+        }
+
+        const float* offsets = ditherEnabled ? dither.data() : nullptr;
+
+        if (! noiseShapingEnabled)
+        {
+            quantizeKernel (block, count, step, inverseStep, offsets);
+            continue;
+        }
+
+        // First-order error feedback: the quantization error is fed back with a one
+        // sample delay, shaping the noise by (1 - z^-1) towards high frequencies
+        float error = state.shapingError;
+
+        for (int i = 0; i < count; ++i)
+        {
+            const float target = block[i] - error;
+            const float quantized = step * std::nearbyint (target * inverseStep + (offsets != nullptr ? offsets[i] : 0.0f));
+            error = quantized - target;
+            block[i] = quantized;
+        }
+
+        state.shapingError = error;
+    }
+}
+
+//==============================================================================
+void ReduxProcessor::quantizeDefault (float* data, int numSamples, float step, float inverseStep, const float* dither) noexcept
+{
+    quantizeBlock (data, numSamples, step, inverseStep, dither);
+}
+
+void ReduxProcessor::quantizeAVX2 (float* data, int numSamples, float step, float inverseStep, const float* dither) noexcept
+{
+#if BYTEMARK_RUNTIME_AVX2
+    jassert (hasAVX2Quantizer());
+    quantizeBlockAVX2 (data, numSamples, step, inverseStep, dither);
+#else
+    // AVX builds (or non-x86 ones) only have the default kernel
+    quantizeBlock (data, numSamples, step, inverseStep, dither);
+#endif
+}
+
+bool ReduxProcessor::hasAVX2Quantizer() noexcept
+{
+#if BYTEMARK_RUNTIME_AVX2
+    return juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/**
+    The bitcrusher / redux stage: bit-depth and sample-rate reduction, in place.
+
+    - Bit depth is continuous: the quantizer step is 2^(1 - bits), so 16 bits
+      matches 16-bit integer audio and fractional settings glide between depths.
+    - Optional TPDF dither (two counter-based noise streams, one LSB peak) and
+      first-order error-feedback noise shaping.
+    - The rate reduction is a sample-and-hold at any (fractional) rate. Each new
+      value is taken at the exact crossing time, and with anti-aliasing on, every
+      step is drawn as a band-limited minimum-phase step (minBLEP) instead of an
+      instantaneous jump, so the images of the held signal don't fold back.
+
+    Quantization is vectorised and picks its instruction set at runtime (AVX2 when
+    the CPU has it, otherwise the build's SSE/NEON/scalar path). Noise shaping and
+    the sample-and-hold are inherently sample-serial.
+*/
+class ReduxProcessor
+{
+public:
+    static constexpr float minBitDepth = 1.0f;
+    static constexpr float maxBitDepth = 24.0f; ///< at (or above) this the quantizer is off.
+
+    /** Length of the band-limited step correction, in samples. */
+    static constexpr int blepLength = 16;
+
+    ReduxProcessor();
+
+    //==========================================================================
+    /** Allocates the per-channel state (off the audio thread). */
+    void prepare (double newSampleRate, int numChannels);
+
+    /** Clears the held values, pending step corrections and noise-shaping error. */
+    void reset() noexcept;
+
+    /** Continuous bit depth between minBitDepth and maxBitDepth. */
+    void setBitDepth (float newBitDepth) noexcept;
+
+    void setDitherEnabled (bool shouldDither) noexcept { ditherEnabled = shouldDither; }
+    void setNoiseShapingEnabled (bool shouldShape) noexcept { noiseShapingEnabled = shouldShape; }
+
+    /** Sample-and-hold rate in Hz; 0 (the default) or anything at or above the host
+        rate turns the rate reduction off.
+    */
+    void setTargetSampleRate (double newRate) noexcept;
+
+    /** Band-limited (minBLEP) edges for the sample-and-hold steps (on by default). */
+    void setAntiAliasingEnabled (bool shouldAntiAlias) noexcept { antiAliasingEnabled = shouldAntiAlias; }
+
+    //==========================================================================
+    /** Processes the buffer in place. */
+    void process (juce::AudioBuffer<float>& buffer) noexcept;
+
+    //==========================================================================
+    /** The quantizer kernels, public so the instruction sets can be checked against
+        each other: data[i] = step * round (data[i] * inverseStep + dither[i]),
+        rounding to nearest-even. dither may be null.
+    */
+    static void quantizeDefault (float* data, int numSamples, float step, float inverseStep, const float* dither) noexcept;
+
+    /** The AVX2 + FMA kernel. Only call it when hasAVX2Quantizer() is true. */
+    static void quantizeAVX2 (float* data, int numSamples, float step, float inverseStep, const float* dither) noexcept;
+
+    /** True when the AVX2 kernel is compiled in and the CPU can run it. */
+    static bool hasAVX2Quantizer() noexcept;
+
+private:
+    //==========================================================================
+    struct ChannelState
+    {
+        float held = 0.0f; ///< current sample-and-hold output.
+        float previousInput = 0.0f; ///< for the value at the exact crossing time.
+        float shapingError = 0.0f; ///< last quantization error (noise shaping).
+
+        // Pending minBLEP corrections for the next blepLength samples (ring)
+        std::array<float, blepLength> blep {};
+        int blepPosition = 0;
+
+        uint32_t ditherSeeds[2] {}; ///< the two uniform streams behind the TPDF dither.
+    };
+
+    using QuantizeKernel = void (*) (float* data, int numSamples, float step, float inverseStep, const float* dither) noexcept;
+
+    /** Sample-and-hold one channel from the given phase; returns the phase it ends on. */
+    double holdSamples (ChannelState& state, float* data, int numSamples, double phase) const noexcept;
+
+    /** Adds a band-limited correction for a step of delta that happened fraction samples ago. */
+    static void addBlep (ChannelState& state, float delta, float fraction) noexcept;
+
+    void quantize (ChannelState& state, float* data, int numSamples) const noexcept;
+
+    //==========================================================================
+    std::vector<ChannelState> channels;
+    double sampleRate = 44100.0;
+
+    float bitDepth = maxBitDepth;
+    float step = 0.0f; ///< quantizer step, 2^(1 - bitDepth).
+    bool ditherEnabled = false;
+    bool noiseShapingEnabled = false;
+
+    double targetSampleRate = 0.0;
+    double holdIncrement = 1.0; ///< target / host rate, 1 = no rate reduction.
+    double holdPhase = 0.0; ///< shared by every channel so they step together.
+    bool antiAliasingEnabled = true;
+
+    uint32_t ditherIndex = 0;
+
+    QuantizeKernel quantizeKernel = nullptr; ///< picked for the CPU at construction.
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReduxProcessor)
+};
@@ -25,6 +25,9 @@ ReferenceTabComponent::ReferenceTabComponent(PluginProcessor& p)
     addAndMakeVisible(lpcAlpha);
     addAndMakeVisible (lpcSampleRate);
     addAndMakeVisible (lpcPitchEnabledButton);
+
+    // paint() fills the whole page
+    setOpaque (true);
 }
 
 ReferenceTabComponent::~ReferenceTabComponent()
@@ -0,0 +1,295 @@
+//
+// Small vectorised kernels shared by the DSP classes.
+//
+// Each kernel picks the widest instruction set the translation unit is compiled
+// for (AVX, SSE, NEON) and falls back to plain scalar code otherwise.
+//
+
+#ifndef SIMDKERNELS_H
+#define SIMDKERNELS_H
+#pragma once
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+    #define BYTEMARK_SIMD_AVX 1
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #include <xmmintrin.h>
+    #define BYTEMARK_SIMD_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define BYTEMARK_SIMD_NEON 1
+#endif
+
+// Integer lanes (for the noise kernel) need AVX2 / SSE4.1 for 32-bit multiplies
+#if defined(__AVX2__)
+    #define BYTEMARK_SIMD_INT_AVX2 1
+#elif defined(__SSE4_1__)
+    #include <smmintrin.h>
+    #define BYTEMARK_SIMD_INT_SSE41 1
+#elif BYTEMARK_SIMD_NEON
+    #define BYTEMARK_SIMD_INT_NEON 1
+#endif
+
+// Float bit manipulation (the log kernel) only needs SSE2's integer lanes
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define BYTEMARK_SIMD_BITS_SSE2 1
+#endif
+
+#include <cstdint>
+#include <cstring>
+
+namespace SIMDKernels
+{
+    /** Number of float lanes used by the kernels in this build. */
+#if BYTEMARK_SIMD_AVX
+    constexpr int floatLanes = 8;
+#elif BYTEMARK_SIMD_SSE || BYTEMARK_SIMD_NEON
+    constexpr int floatLanes = 4;
+#else
+    constexpr int floatLanes = 1;
+#endif
+
+    /** Returns sum(a[i] * b[i]) for i in [0, n). Pointers need not be aligned. */
+    inline float dotProduct (const float* a, const float* b, int n) noexcept
+    {
+        int i = 0;
+        float sum = 0.0f;
+
+#if BYTEMARK_SIMD_AVX
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+
+        for (; i + 16 <= n; i += 16)
+        {
+            acc0 = _mm256_add_ps (acc0, _mm256_mul_ps (_mm256_loadu_ps (a + i), _mm256_loadu_ps (b + i)));
+            acc1 = _mm256_add_ps (acc1, _mm256_mul_ps (_mm256_loadu_ps (a + i + 8), _mm256_loadu_ps (b + i + 8)));
+        }
+
+        acc0 = _mm256_add_ps (acc0, acc1);
+        const __m128 half = _mm_add_ps (_mm256_castps256_ps128 (acc0), _mm256_extractf128_ps (acc0, 1));
+        const __m128 pairs = _mm_add_ps (half, _mm_movehl_ps (half, half));
+        sum = _mm_cvtss_f32 (_mm_add_ss (pairs, _mm_shuffle_ps (pairs, pairs, 1)));
+#elif BYTEMARK_SIMD_SSE
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+
+        for (; i + 8 <= n; i += 8)
+        {
+            acc0 = _mm_add_ps (acc0, _mm_mul_ps (_mm_loadu_ps (a + i), _mm_loadu_ps (b + i)));
+            acc1 = _mm_add_ps (acc1, _mm_mul_ps (_mm_loadu_ps (a + i + 4), _mm_loadu_ps (b + i + 4)));
+        }
+
+        acc0 = _mm_add_ps (acc0, acc1);
+        const __m128 pairs = _mm_add_ps (acc0, _mm_movehl_ps (acc0, acc0));
+        sum = _mm_cvtss_f32 (_mm_add_ss (pairs, _mm_shuffle_ps (pairs, pairs, 1)));
+#elif BYTEMARK_SIMD_NEON
+        float32x4_t acc0 = vdupq_n_f32 (0.0f);
+        float32x4_t acc1 = vdupq_n_f32 (0.0f);
+
+        for (; i + 8 <= n; i += 8)
+        {
+            acc0 = vmlaq_f32 (acc0, vld1q_f32 (a + i), vld1q_f32 (b + i));
+            acc1 = vmlaq_f32 (acc1, vld1q_f32 (a + i + 4), vld1q_f32 (b + i + 4));
+        }
+
+        acc0 = vaddq_f32 (acc0, acc1);
+        const float32x2_t pairs = vadd_f32 (vget_low_f32 (acc0), vget_high_f32 (acc0));
+        sum = vget_lane_f32 (vpadd_f32 (pairs, pairs), 0);
+#endif
+
+        for (; i < n; ++i)
+            sum += a[i] * b[i];
+
+        return sum;
+    }
+
+    //==========================================================================
+    /** Counter-based hash (lowbias32) behind fillUniformNoise(): sample i of a stream
+        depends only on (seed, index), so any stretch can be regenerated or skipped.
+    */
+    inline uint32_t hashNoise (uint32_t seed, uint32_t index) noexcept
+    {
+        uint32_t x = (index * 0x9e3779b9u) ^ seed;
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    /** Writes uniform noise in [-1, 1) for stream indices firstIndex .. firstIndex + n - 1.
+        Every instruction set produces bit-identical output.
+    */
+    inline void fillUniformNoise (float* dest, int n, uint32_t seed, uint32_t firstIndex) noexcept
+    {
+        constexpr float scale = 2.0f / 16777216.0f; // 24-bit mantissa -> [0, 2)
+        int i = 0;
+
+#if BYTEMARK_SIMD_INT_AVX2
+        const __m256i golden = _mm256_set1_epi32 ((int) 0x9e3779b9u);
+        const __m256i mul1 = _mm256_set1_epi32 ((int) 0x7feb352du);
+        const __m256i mul2 = _mm256_set1_epi32 ((int) 0x846ca68bu);
+        const __m256i seedVec = _mm256_set1_epi32 ((int) seed);
+        const __m256 scaleVec = _mm256_set1_ps (scale);
+        const __m256 one = _mm256_set1_ps (1.0f);
+        __m256i index = _mm256_add_epi32 (_mm256_set1_epi32 ((int) firstIndex), _mm256_setr_epi32 (0, 1, 2, 3, 4, 5, 6, 7));
+
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256i x = _mm256_xor_si256 (_mm256_mullo_epi32 (index, golden), seedVec);
+            x = _mm256_xor_si256 (x, _mm256_srli_epi32 (x, 16));
+            x = _mm256_mullo_epi32 (x, mul1);
+            x = _mm256_xor_si256 (x, _mm256_srli_epi32 (x, 15));
+            x = _mm256_mullo_epi32 (x, mul2);
+            x = _mm256_xor_si256 (x, _mm256_srli_epi32 (x, 16));
+
+            const __m256 value = _mm256_cvtepi32_ps (_mm256_srli_epi32 (x, 8));
+            _mm256_storeu_ps (dest + i, _mm256_sub_ps (_mm256_mul_ps (value, scaleVec), one));
+            index = _mm256_add_epi32 (index, _mm256_set1_epi32 (8));
+        }
+#elif BYTEMARK_SIMD_INT_SSE41
+        const __m128i golden = _mm_set1_epi32 ((int) 0x9e3779b9u);
+        const __m128i mul1 = _mm_set1_epi32 ((int) 0x7feb352du);
+        const __m128i mul2 = _mm_set1_epi32 ((int) 0x846ca68bu);
+        const __m128i seedVec = _mm_set1_epi32 ((int) seed);
+        const __m128 scaleVec = _mm_set1_ps (scale);
+        const __m128 one = _mm_set1_ps (1.0f);
+        __m128i index = _mm_add_epi32 (_mm_set1_epi32 ((int) firstIndex), _mm_setr_epi32 (0, 1, 2, 3));
+
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128i x = _mm_xor_si128 (_mm_mullo_epi32 (index, golden), seedVec);
+            x = _mm_xor_si128 (x, _mm_srli_epi32 (x, 16));
+            x = _mm_mullo_epi32 (x, mul1);
+            x = _mm_xor_si128 (x, _mm_srli_epi32 (x, 15));
+            x = _mm_mullo_epi32 (x, mul2);
+            x = _mm_xor_si128 (x, _mm_srli_epi32 (x, 16));
+
+            const __m128 value = _mm_cvtepi32_ps (_mm_srli_epi32 (x, 8));
+            _mm_storeu_ps (dest + i, _mm_sub_ps (_mm_mul_ps (value, scaleVec), one));
+            index = _mm_add_epi32 (index, _mm_set1_epi32 (4));
+        }
+#elif BYTEMARK_SIMD_INT_NEON
+        const uint32x4_t seedVec = vdupq_n_u32 (seed);
+        const uint32_t lanes[4] = { 0, 1, 2, 3 };
+        uint32x4_t index = vaddq_u32 (vdupq_n_u32 (firstIndex), vld1q_u32 (lanes));
+
+        for (; i + 4 <= n; i += 4)
+        {
+            uint32x4_t x = veorq_u32 (vmulq_n_u32 (index, 0x9e3779b9u), seedVec);
+            x = veorq_u32 (x, vshrq_n_u32 (x, 16));
+            x = vmulq_n_u32 (x, 0x7feb352du);
+            x = veorq_u32 (x, vshrq_n_u32 (x, 15));
+            x = vmulq_n_u32 (x, 0x846ca68bu);
+            x = veorq_u32 (x, vshrq_n_u32 (x, 16));
+
+            const float32x4_t value = vcvtq_f32_u32 (vshrq_n_u32 (x, 8));
+            vst1q_f32 (dest + i, vsubq_f32 (vmulq_n_f32 (value, scale), vdupq_n_f32 (1.0f)));
+            index = vaddq_u32 (index, vdupq_n_u32 (4));
+        }
+#endif
+
+        for (; i < n; ++i)
+            dest[i] = (float) (hashNoise (seed, firstIndex + (uint32_t) i) >> 8) * scale - 1.0f;
+    }
+
+    //==========================================================================
+    // log2 (1 + t) for t in [0, 1): degree-4 least-squares fit, max error ~1.2e-4
+    // (0.0007 dB) - plenty for metering, not meant for the signal path
+    constexpr float log2Coefficients[4] = { 1.43863803f, -0.677743267f, 0.321879707f, -0.0828606983f };
+
+    /** Fast log2 of a positive, normal float (the scalar version of the gainsToDecibels() kernel). */
+    inline float fastLog2 (float x) noexcept
+    {
+        uint32_t bits;
+        std::memcpy (&bits, &x, sizeof (bits));
+
+        const float exponent = (float) ((int) (bits >> 23) - 127);
+        const uint32_t mantissaBits = (bits & 0x007fffffu) | 0x3f800000u;
+        float mantissa;
+        std::memcpy (&mantissa, &mantissaBits, sizeof (mantissa));
+
+        const float t = mantissa - 1.0f;
+        const auto& c = log2Coefficients;
+        return exponent + t * (c[0] + t * (c[1] + t * (c[2] + t * c[3])));
+    }
+
+    /** dest[i] = 20 log10 (max (gains[i], minimumGain)) + offsets[i], using the fast log2
+        above. minimumGain must be positive (it also catches zeros and NaNs).
+    */
+    inline void gainsToDecibels (const float* gains, const float* offsets, float* dest, int n, float minimumGain) noexcept
+    {
+        constexpr float decibelsPerOctave = 6.02059991f; // 20 log10 (2)
+        const auto& c = log2Coefficients;
+        int i = 0;
+
+#if BYTEMARK_SIMD_INT_AVX2
+        const __m256 minGain = _mm256_set1_ps (minimumGain);
+        const __m256 one = _mm256_set1_ps (1.0f);
+        const __m256i mantissaMask = _mm256_set1_epi32 (0x007fffff);
+        const __m256i oneBits = _mm256_set1_epi32 (0x3f800000);
+        const __m256i bias = _mm256_set1_epi32 (127);
+        const __m256 scale = _mm256_set1_ps (decibelsPerOctave);
+
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256i bits = _mm256_castps_si256 (_mm256_max_ps (_mm256_loadu_ps (gains + i), minGain));
+            const __m256 exponent = _mm256_cvtepi32_ps (_mm256_sub_epi32 (_mm256_srli_epi32 (bits, 23), bias));
+            const __m256 t = _mm256_sub_ps (_mm256_castsi256_ps (_mm256_or_si256 (_mm256_and_si256 (bits, mantissaMask), oneBits)), one);
+
+            __m256 poly = _mm256_add_ps (_mm256_set1_ps (c[2]), _mm256_mul_ps (t, _mm256_set1_ps (c[3])));
+            poly = _mm256_add_ps (_mm256_set1_ps (c[1]), _mm256_mul_ps (t, poly));
+            poly = _mm256_add_ps (_mm256_set1_ps (c[0]), _mm256_mul_ps (t, poly));
+
+            const __m256 logValue = _mm256_add_ps (exponent, _mm256_mul_ps (t, poly));
+            _mm256_storeu_ps (dest + i, _mm256_add_ps (_mm256_mul_ps (logValue, scale), _mm256_loadu_ps (offsets + i)));
+        }
+#elif BYTEMARK_SIMD_BITS_SSE2
+        const __m128 minGain = _mm_set1_ps (minimumGain);
+        const __m128 one = _mm_set1_ps (1.0f);
+        const __m128i mantissaMask = _mm_set1_epi32 (0x007fffff);
+        const __m128i oneBits = _mm_set1_epi32 (0x3f800000);
+        const __m128i bias = _mm_set1_epi32 (127);
+        const __m128 scale = _mm_set1_ps (decibelsPerOctave);
+
+        for (; i + 4 <= n; i += 4)
+        {
+            const __m128i bits = _mm_castps_si128 (_mm_max_ps (_mm_loadu_ps (gains + i), minGain));
+            const __m128 exponent = _mm_cvtepi32_ps (_mm_sub_epi32 (_mm_srli_epi32 (bits, 23), bias));
+            const __m128 t = _mm_sub_ps (_mm_castsi128_ps (_mm_or_si128 (_mm_and_si128 (bits, mantissaMask), oneBits)), one);
+
+            __m128 poly = _mm_add_ps (_mm_set1_ps (c[2]), _mm_mul_ps (t, _mm_set1_ps (c[3])));
+            poly = _mm_add_ps (_mm_set1_ps (c[1]), _mm_mul_ps (t, poly));
+            poly = _mm_add_ps (_mm_set1_ps (c[0]), _mm_mul_ps (t, poly));
+
+            const __m128 logValue = _mm_add_ps (exponent, _mm_mul_ps (t, poly));
+            _mm_storeu_ps (dest + i, _mm_add_ps (_mm_mul_ps (logValue, scale), _mm_loadu_ps (offsets + i)));
+        }
+#elif BYTEMARK_SIMD_NEON
+        const float32x4_t minGain = vdupq_n_f32 (minimumGain);
+        const float32x4_t one = vdupq_n_f32 (1.0f);
+
+        for (; i + 4 <= n; i += 4)
+        {
+            const uint32x4_t bits = vreinterpretq_u32_f32 (vmaxq_f32 (vld1q_f32 (gains + i), minGain));
+            const float32x4_t exponent = vcvtq_f32_s32 (vsubq_s32 (vreinterpretq_s32_u32 (vshrq_n_u32 (bits, 23)), vdupq_n_s32 (127)));
+            const uint32x4_t mantissaBits = vorrq_u32 (vandq_u32 (bits, vdupq_n_u32 (0x007fffffu)), vdupq_n_u32 (0x3f800000u));
+            const float32x4_t t = vsubq_f32 (vreinterpretq_f32_u32 (mantissaBits), one);
+
+            float32x4_t poly = vaddq_f32 (vdupq_n_f32 (c[2]), vmulq_n_f32 (t, c[3]));
+            poly = vaddq_f32 (vdupq_n_f32 (c[1]), vmulq_f32 (t, poly));
+            poly = vaddq_f32 (vdupq_n_f32 (c[0]), vmulq_f32 (t, poly));
+
+            const float32x4_t logValue = vaddq_f32 (exponent, vmulq_f32 (t, poly));
+            vst1q_f32 (dest + i, vaddq_f32 (vmulq_n_f32 (logValue, decibelsPerOctave), vld1q_f32 (offsets + i)));
+        }
+#endif
+
+        for (; i < n; ++i)
+            dest[i] = fastLog2 (gains[i] > minimumGain ? gains[i] : minimumGain) * decibelsPerOctave + offsets[i];
+    }
+}
+
+#endif //SIMDKERNELS_H
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "MainTabComponent.h"
+#include "FilmstripCache.h"
 
 #include <juce_graphics/juce_graphics.h>
 #include <juce_gui_basics/juce_gui_basics.h>
@@ -62,26 +63,17 @@ public:
             float /*rotaryEndAngle*/,
             juce::Slider& /*slider*/) override
         {
-            const int frames = static_cast<int>(height/width);
-            const auto frameId = static_cast<int>(ceil(sliderPosProportional * (static_cast<float>(frames) - 1.0f)));
-
-            // image is vertical strip, each frame is 1/100th of the height
-
-            g.drawImage(image,
-                x,
-                y,
-                width,
-                height,
-                0,
-                frameId * image.getHeight() / frames,
-                image.getWidth(),
-                image.getHeight() / frames);
+            // image is a vertical strip of square frames (101 for the 62x62 knob); the
+            // frame is blitted from the shared cache, pre-scaled to this size
+            filmstrips->drawFrame(g, image, sliderPosProportional, { x, y, width, height });
         }
 
     private:
         juce::Image image;
         juce::Image byImage;
 
+        juce::SharedResourcePointer<FilmstripCache> filmstrips;
+
         bool bp = false;
 
 
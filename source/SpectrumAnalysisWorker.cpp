@@ -0,0 +1,186 @@
+#include "SpectrumAnalysisWorker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // The pre-STFT analyzer: 1024 points, no overlap, at 48 kHz. Magnitudes are
+    // scaled to this size, and the smoothing control is calibrated to its frame rate.
+    constexpr int referenceFftSize = 1024;
+    constexpr double referenceFramePeriod = referenceFftSize / 48000.0;
+
+    /** Release time constant, in seconds, equivalent to a per-frame smoothing factor. */
+    double releaseTimeFor (float smoothingFactor)
+    {
+        if (smoothingFactor <= 0.0f)
+            return 0.0;
+
+        if (smoothingFactor >= 1.0f)
+            return std::numeric_limits<double>::infinity();
+
+        return -referenceFramePeriod / std::log ((double) smoothingFactor);
+    }
+
+    /** One-pole coefficient for a time constant, over a step of the given length. */
+    float coefficientFor (double timeConstant, double stepSeconds)
+    {
+        return timeConstant > 0.0 ? (float) std::exp (-stepSeconds / timeConstant) : 0.0f;
+    }
+
+    void resizeFrame (std::vector<float>& values, int size)
+    {
+        if ((int) values.size() != size)
+            values.assign ((size_t) size, 0.0f);
+    }
+}
+
+//==============================================================================
+SpectrumAnalysisWorker::SpectrumAnalysisWorker (VisualizerFifo& source)
+    : juce::Thread ("ByteMark Spectrum Analysis"),
+      fifo (source)
+{
+    configure (defaultFftOrder, 2);
+
+    frames.prepare ([this] (Frame& frame) {
+        resizeFrame (frame.mid, numBins);
+        resizeFrame (frame.side, numBins);
+        resizeFrame (frame.midPeak, numBins);
+        resizeFrame (frame.sidePeak, numBins);
+    });
+}
+
+SpectrumAnalysisWorker::~SpectrumAnalysisWorker()
+{
+    stop();
+}
+
+void SpectrumAnalysisWorker::start()
+{
+    fifo.setConsumerActive (true);
+    startThread (juce::Thread::Priority::low);
+}
+
+void SpectrumAnalysisWorker::stop()
+{
+    fifo.setConsumerActive (false);
+    stopThread (1000);
+}
+
+void SpectrumAnalysisWorker::setAnalysisSize (int newFftOrder, int newOverlapFactor) noexcept
+{
+    requestedOrder.store (juce::jlimit (minFftOrder, maxFftOrder, newFftOrder), std::memory_order_relaxed);
+    requestedOverlap.store (newOverlapFactor >= 4 ? 4 : 2, std::memory_order_relaxed);
+}
+
+//==============================================================================
+void SpectrumAnalysisWorker::configure (int newFftOrder, int newOverlapFactor)
+{
+    fftOrder = newFftOrder;
+    fftSize = 1 << fftOrder;
+    hopSize = fftSize / newOverlapFactor;
+    numBins = fftSize / 2;
+
+    // Same level on screen whatever the size (the window is normalised to sum to fftSize)
+    magnitudeScale = (float) referenceFftSize / (float) fftSize;
+
+    forwardFFT = std::make_unique<juce::dsp::FFT> (fftOrder);
+    window = std::make_unique<juce::dsp::WindowingFunction<float>> ((size_t) fftSize, juce::dsp::WindowingFunction<float>::hamming);
+
+    midHistory.assign ((size_t) fftSize, 0.0f);
+    sideHistory.assign ((size_t) fftSize, 0.0f);
+    hopMid.assign ((size_t) hopSize, 0.0f);
+    hopSide.assign ((size_t) hopSize, 0.0f);
+    fftData.assign ((size_t) fftSize * 2, 0.0f);
+
+    for (auto* state : { &smoothedMid, &smoothedSide, &peakMid, &peakSide, &peakAgeMid, &peakAgeSide })
+        state->assign ((size_t) numBins, 0.0f);
+}
+
+void SpectrumAnalysisWorker::run()
+{
+    // Released meters decay towards zero: keep them out of the denormal range
+    const juce::ScopedNoDenormals noDenormals;
+
+    while (! threadShouldExit())
+    {
+        const int order = requestedOrder.load (std::memory_order_relaxed);
+        const int overlap = requestedOverlap.load (std::memory_order_relaxed);
+
+        if (order != fftOrder || overlap != fftSize / hopSize)
+            configure (order, overlap);
+
+        // Drain every whole hop that's waiting; the UI only ever shows the newest frame
+        while (fifo.getNumReady() >= hopSize && ! threadShouldExit())
+        {
+            if (! fifo.pullMidSide (hopMid.data(), hopSide.data(), hopSize))
+                break;
+
+            // Slide the analysis window along by one hop
+            std::copy (midHistory.begin() + hopSize, midHistory.end(), midHistory.begin());
+            std::copy (sideHistory.begin() + hopSize, sideHistory.end(), sideHistory.begin());
+            std::copy (hopMid.begin(), hopMid.end(), midHistory.end() - hopSize);
+            std::copy (hopSide.begin(), hopSide.end(), sideHistory.end() - hopSize);
+
+            analyse();
+        }
+
+        // The shortest hop (512 points at 75%) takes ~2.7 ms to arrive at 48 kHz
+        wait (2);
+    }
+}
+
+void SpectrumAnalysisWorker::analyse()
+{
+    const double hopSeconds = hopSize / fifo.getSampleRate();
+    const float attack = coefficientFor (attackSeconds, hopSeconds);
+    const float release = coefficientFor (releaseTimeFor (smoothing.load (std::memory_order_relaxed)), hopSeconds);
+    const float peakDecay = (float) juce::Decibels::decibelsToGain (-peakDecayDecibelsPerSecond * hopSeconds);
+
+    auto meter = [&] (const std::vector<float>& samples,
+                      std::vector<float>& smoothed,
+                      std::vector<float>& peak,
+                      std::vector<float>& peakAge) {
+        std::copy (samples.begin(), samples.end(), fftData.begin());
+        window->multiplyWithWindowingTable (fftData.data(), (size_t) fftSize);
+        forwardFFT->performFrequencyOnlyForwardTransform (fftData.data());
+
+        for (size_t i = 0; i < (size_t) numBins; ++i)
+        {
+            // Ballistics: fast attack, release set by the smoothing control
+            const float target = fftData[i] * magnitudeScale;
+            const float coefficient = target > smoothed[i] ? attack : release;
+            smoothed[i] = target + coefficient * (smoothed[i] - target);
+
+            // Peak hold, then a steady decay in dB
+            if (smoothed[i] >= peak[i])
+            {
+                peak[i] = smoothed[i];
+                peakAge[i] = 0.0f;
+            }
+            else if ((peakAge[i] += (float) hopSeconds) > (float) peakHoldSeconds)
+            {
+                peak[i] = juce::jmax (smoothed[i], peak[i] * peakDecay);
+            }
+        }
+    };
+
+    meter (midHistory, smoothedMid, peakMid, peakAgeMid);
+    meter (sideHistory, smoothedSide, peakSide, peakAgeSide);
+
+    // The worker owns this slot, so resizing it after a size change is safe
+    auto& frame = frames.getWriteBuffer();
+    resizeFrame (frame.mid, numBins);
+    resizeFrame (frame.side, numBins);
+    resizeFrame (frame.midPeak, numBins);
+    resizeFrame (frame.sidePeak, numBins);
+
+    std::copy (smoothedMid.begin(), smoothedMid.end(), frame.mid.begin());
+    std::copy (smoothedSide.begin(), smoothedSide.end(), frame.side.begin());
+    std::copy (peakMid.begin(), peakMid.end(), frame.midPeak.begin());
+    std::copy (peakSide.begin(), peakSide.end(), frame.sidePeak.begin());
+    frame.sampleRate = fifo.getSampleRate();
+
+    frames.publish();
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "TripleBuffer.h"
+#include "VisualizerFifo.h"
+
+#include <juce_core/juce_core.h>
+#include <juce_dsp/juce_dsp.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+    Runs the spectrum analysis for the visualizer on its own low-priority thread.
+
+    The worker drains the processor's VisualizerFifo into an overlapped STFT (512
+    to 8192 points, 50% or 75% overlap) of the mid and side signals. Each frame's
+    magnitudes go through attack/release ballistics and a peak hold with decay,
+    all defined as times in seconds, so the meter moves at the same speed
+    whatever the FFT size, overlap or UI frame rate. Finished frames are published
+    through a triple buffer: the UI thread only picks up the newest one
+    (pollNewFrame) and draws it.
+
+    Every analysis buffer belongs to the worker (and so to one editor), and is
+    reallocated only when the FFT size or overlap changes.
+*/
+class SpectrumAnalysisWorker : private juce::Thread
+{
+public:
+    static constexpr int minFftOrder = 9; ///< 512 points.
+    static constexpr int maxFftOrder = 13; ///< 8192 points.
+    static constexpr int defaultFftOrder = 11; ///< 2048 points.
+
+    static constexpr double attackSeconds = 0.01;
+    static constexpr double peakHoldSeconds = 1.0;
+    static constexpr double peakDecayDecibelsPerSecond = 12.0;
+
+    /** One published analysis result. */
+    struct Frame
+    {
+        std::vector<float> mid, side; ///< magnitudes after the ballistics, one per bin.
+        std::vector<float> midPeak, sidePeak; ///< held peaks.
+        double sampleRate = VisualizerFifo::maxAnalysisRate; ///< rate the bins refer to.
+    };
+
+    explicit SpectrumAnalysisWorker (VisualizerFifo& source);
+    ~SpectrumAnalysisWorker() override;
+
+    /** Starts and stops the analysis thread (and the processor's feed with it). */
+    void start();
+    void stop();
+
+    /** FFT size as a power of two, and overlap as frames per FFT length (2 = 50%,
+        4 = 75%). Safe from any thread; the worker switches at its next frame.
+    */
+    void setAnalysisSize (int newFftOrder, int newOverlapFactor) noexcept;
+
+    /** Release smoothing, 0 (none) to 1 (frozen). Safe from any thread.
+
+        Kept compatible with the old per-frame smoothing factor: a value s gives the
+        release time constant the factor had at the old fixed frame rate (1024
+        points, no overlap, 48 kHz), and that time constant holds at any size.
+    */
+    void setSmoothing (float newSmoothing) noexcept { smoothing.store (newSmoothing, std::memory_order_relaxed); }
+
+    //==========================================================================
+    // UI thread
+
+    /** Picks up the newest frame, if one was published since the last call. */
+    bool pollNewFrame() noexcept { return frames.update(); }
+
+    const Frame& getLatestFrame() const noexcept { return frames.getReadBuffer(); }
+
+private:
+    //==========================================================================
+    void run() override;
+
+    /** (Re)allocates everything for the requested size and overlap, clearing the history. */
+    void configure (int newFftOrder, int newOverlapFactor);
+
+    /** Transforms the current history, runs the ballistics and publishes a frame. */
+    void analyse();
+
+    VisualizerFifo& fifo;
+
+    // Analysis setup (worker thread only)
+    std::unique_ptr<juce::dsp::FFT> forwardFFT;
+    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    int fftOrder = 0, fftSize = 0, hopSize = 0, numBins = 0;
+    float magnitudeScale = 1.0f;
+
+    // Sliding input (the last fftSize samples) and the hop being pulled in
+    std::vector<float> midHistory, sideHistory;
+    std::vector<float> hopMid, hopSide;
+    std::vector<float> fftData; // For real and imaginary parts
+
+    // Per-bin meter state
+    std::vector<float> smoothedMid, smoothedSide;
+    std::vector<float> peakMid, peakSide;
+    std::vector<float> peakAgeMid, peakAgeSide; ///< seconds since each peak was set.
+
+    std::atomic<int> requestedOrder { defaultFftOrder }, requestedOverlap { 2 };
+    std::atomic<float> smoothing { 0.5f };
+
+    TripleBuffer<Frame> frames;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumAnalysisWorker)
+};
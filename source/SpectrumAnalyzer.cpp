@@ -1,14 +1,20 @@
 #include "SpectrumAnalyzer.h"
+#include "SIMDKernels.h"
+
+#include <cmath>
 
 SpectrumAnalyzer::SpectrumAnalyzer(PluginProcessor& p)
-    : forwardFFT(fftOrder),
-      window(fftSize, juce::dsp::WindowingFunction<float>::hamming),
-      processorRef(p)
+    : processorRef(p),
+      analysisWorker(p.visualizerFifo),
+      fftSizeParameter(p.apvts.getRawParameterValue("VIS_FFT_SIZE")),
+      overlapParameter(p.apvts.getRawParameterValue("VIS_OVERLAP")),
+      smoothingParameter(p.apvts.getRawParameterValue("VIS_SMOOTH"))
 {
-    fifo.fill(0);
-    fftData.fill(0);
-    midSpectrum.resize(fftSize / 2, 0.0f);
-    sideSpectrum.resize(fftSize / 2, 0.0f);
+    // The cached grid image covers every pixel
+    setOpaque(true);
+
+    // The processor only feeds the transport while the worker is listening
+    analysisWorker.start();
     startTimerHz(60); // Update at 60 FPS
 }
 
@@ -16,258 +22,191 @@ SpectrumAnalyzer::SpectrumAnalyzer(PluginProcessor& p)
 SpectrumAnalyzer::~SpectrumAnalyzer()
 {
     stopTimer();
+    analysisWorker.stop();
 }
 
 void SpectrumAnalyzer::paint(juce::Graphics& g)
 {
-    g.fillAll(juce::Colours::black);
+    // Background and grid come from a cached image at the display's pixel scale
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (gridImage.isNull() || scale != gridScale)
+        renderGrid(scale);
+
+    g.drawImage(gridImage, getLocalBounds().toFloat());
 
     drawFrame(g);
 }
 
 void SpectrumAnalyzer::resized()
 {
-    // No need for layout in this component
+    const auto& frame = analysisWorker.getLatestFrame();
+    updateLayout(frame.sampleRate, (int) frame.mid.size());
 }
 
 void SpectrumAnalyzer::setVisualizerSmoothingValue(float val)
 {
-    visualizerSmoothingValue = val;
+    analysisWorker.setSmoothing(val);
 }
 
-
-void SpectrumAnalyzer::pushBuffer(const juce::AudioBuffer<float>& buffer)
+void SpectrumAnalyzer::timerCallback()
 {
-    auto numSamples = buffer.getNumSamples();
-    auto writePointer = buffer.getReadPointer(0); // Assuming stereo input
+    // The worker only reconfigures when these actually change
+    analysisWorker.setAnalysisSize(SpectrumAnalysisWorker::minFftOrder + juce::roundToInt(fftSizeParameter->load()),
+                                   overlapParameter->load() > 0.5f ? 4 : 2);
+    analysisWorker.setSmoothing(smoothingParameter->load());
 
-    for (int i = 0; i < numSamples; ++i)
-    {
-        // Calculate mid and side
-        float left = buffer.getSample(0, i);
-        float right = buffer.getSample(1, i);
+    // Just swap in the worker's newest frame, if there is one
+    if (! analysisWorker.pollNewFrame())
+        return;
 
-        float mid = (left + right) * 0.5f;
-        float side = (left - right) * 0.5f;
+    // The bin layout only changes with the analysis rate or FFT size
+    const auto& frame = analysisWorker.getLatestFrame();
 
-        // Push mid signal into FIFO
-        if (fifoIndex < fftSize)
-        {
-            fifo[fifoIndex++] = mid;
-        }
-
-        // When FIFO is full, set flag for FFT processing
-        if (fifoIndex == fftSize)
-        {
-            std::copy(fifo.begin(), fifo.end(), fftData.begin());
-            window.multiplyWithWindowingTable(fftData.data(), fftSize);
-            forwardFFT.performFrequencyOnlyForwardTransform(fftData.data());
-
-            // Copy the spectrum data
-            midSpectrum.assign(fftData.begin(), fftData.begin() + fftSize / 2);
+    if (frame.sampleRate != layoutSampleRate || (int) frame.mid.size() != layoutNumBins)
+        updateLayout(frame.sampleRate, (int) frame.mid.size());
 
-            // Reset FIFO for side signal
-            fifoIndex = 0;
-
-            // Now process side signal
-            for (int j = 0; j < fftSize; ++j)
-            {
-                fifo[j] = side;
-            }
-
-            window.multiplyWithWindowingTable(fifo.data(), fftSize);
-            forwardFFT.performFrequencyOnlyForwardTransform(fifo.data());
-
-            // Copy the spectrum data
-            sideSpectrum.assign(fifo.begin(), fifo.begin() + fftSize / 2);
+    repaint();
+}
 
-            nextFFTBlockReady = true;
-        }
-    }
+float SpectrumAnalyzer::frequencyToX(double frequency) const noexcept
+{
+    // Logarithmic axis from referenceFrequency to Nyquist
+    const double nyquist = layoutSampleRate * 0.5;
+    return (float) (std::log10(frequency / referenceFrequency) / std::log10(nyquist / referenceFrequency) * getWidth());
 }
 
-void SpectrumAnalyzer::timerCallback()
+void SpectrumAnalyzer::updateLayout(double sampleRate, int numBins)
 {
-    // DBG("SpectrumAnalyzer timerCallback called");
-    juce::AudioBuffer<float> buffer(2, fftSize);
+    layoutSampleRate = sampleRate;
+    layoutNumBins = numBins;
+    gridImage = {}; // the visible markers depend on Nyquist
 
-    if (processorRef.fifoQueue.pull(buffer))
-    {
+    const int width = juce::jmax(0, getWidth());
+    const double nyquist = sampleRate * 0.5;
+    const double binWidth = nyquist / juce::jmax(1, numBins);
+    const double octaveSpan = std::log2(nyquist / referenceFrequency);
 
+    // Slope adjustment per bin: 4.5 dB per octave above the reference frequency
+    binTilt.assign((size_t) numBins, 0.0f);
+    for (int i = 1; i < numBins; ++i)
+        binTilt[(size_t) i] = (float) (std::log2(juce::jmax(1.0, i * binWidth / referenceFrequency)) * slopePerOctave);
 
-        // Process the buffer to compute spectra
-        // (Similar to the previous pushBuffer method)
-        // Copy the code from pushBuffer here
-        auto numSamples = buffer.getNumSamples();
+    midDecibels.assign((size_t) numBins, minDecibels);
+    sideDecibels.assign((size_t) numBins, minDecibels);
+    midPeakSpectrum.assign((size_t) numBins, minDecibels);
+    sidePeakSpectrum.assign((size_t) numBins, minDecibels);
 
-        // Reset the fifoIndex
-        fifoIndex = 0;
+    // Which bins land in each pixel column of the log axis
+    auto columnFrequency = [=] (double x) { return referenceFrequency * std::exp2(octaveSpan * x / width); };
 
-        for (int i = 0; i < numSamples; ++i)
-        {
-            float left = buffer.getSample(0, i);
-            float right = buffer.getSample(1, i);
+    columns.assign((size_t) width, {});
 
-            float mid = (left + right) * 0.5f;
-            float side = (left - right) * 0.5f;
+    for (int x = 0; x < width; ++x)
+    {
+        auto& column = columns[(size_t) x];
+        const int first = (int) std::ceil(columnFrequency(x) / binWidth);
+        const int end = juce::jmin(numBins, (int) std::ceil(columnFrequency(x + 1) / binWidth));
 
-            // Fill the fifo with mid samples
-            if (fifoIndex < fftSize)
-            {
-                fifo[fifoIndex++] = mid;
-            }
+        if (end > first)
+        {
+            // Several bins share the column: show the loudest
+            column.firstBin = first;
+            column.numBins = end - first;
         }
-
-        if (fifoIndex == fftSize)
+        else
         {
-            // Process mid signal
-            std::copy(fifo.begin(), fifo.end(), fftData.begin());
-            window.multiplyWithWindowingTable(fftData.data(), fftSize);
-            forwardFFT.performFrequencyOnlyForwardTransform(fftData.data());
-
-            midSpectrum.assign(fftData.begin(), fftData.begin() + fftSize / 2);
-
-            // Now process side signal
-            fifoIndex = 0;
-            for (int i = 0; i < numSamples; ++i)
-            {
-                float left = buffer.getSample(0, i);
-                float right = buffer.getSample(1, i);
-
-                float side = (left - right) * 0.5f;
-
-                if (fifoIndex < fftSize)
-                {
-                    fifo[fifoIndex++] = side;
-                }
-            }
-
-            if (fifoIndex == fftSize)
-            {
-                std::copy(fifo.begin(), fifo.end(), fftData.begin());
-                window.multiplyWithWindowingTable(fftData.data(), fftSize);
-                forwardFFT.performFrequencyOnlyForwardTransform(fftData.data());
-
-                sideSpectrum.assign(fftData.begin(), fftData.begin() + fftSize / 2);
-
-                nextFFTBlockReady = true;
-            }
+            // Bins are wider than pixels down low: interpolate between the two around the column centre
+            const double position = juce::jlimit(0.0, (double) juce::jmax(0, numBins - 2), columnFrequency(x + 0.5) / binWidth);
+            column.firstBin = (int) position;
+            column.numBins = 0;
+            column.fraction = (float) (position - column.firstBin);
         }
     }
-
-
-    if (nextFFTBlockReady)
-    {
-        applySmoothing();
-        nextFFTBlockReady = false;
-        repaint();
-    }
 }
 
-void SpectrumAnalyzer::applySmoothing()
+void SpectrumAnalyzer::renderGrid(float scale)
 {
-    static std::vector<float> previousMidSpectrum(midSpectrum.size(), 0.0f);
-    static std::vector<float> previousSideSpectrum(sideSpectrum.size(), 0.0f);
+    gridScale = scale;
 
-    float smoothingFactor = visualizerSmoothingValue; // Adjust between 0.0f (no smoothing) and 1.0f (full smoothing)
+    const int width = getWidth();
+    const int height = getHeight();
+    gridImage = juce::Image(juce::Image::RGB,
+                            juce::jmax(1, juce::roundToInt(width * scale)),
+                            juce::jmax(1, juce::roundToInt(height * scale)),
+                            false);
+
+    juce::Graphics g(gridImage);
+    g.addTransform(juce::AffineTransform::scale(scale));
+    g.fillAll(juce::Colours::black);
 
-    for (size_t i = 0; i < midSpectrum.size(); ++i)
+    // Draw frequency markers
+    g.setColour(juce::Colours::grey);
+    const double nyquist = layoutSampleRate * 0.5;
+    for (auto freq : { 50.0, 100.0, 200.0, 500.0, 1000.0, 2000.0, 5000.0, 10000.0, 20000.0 })
     {
-        midSpectrum[i] = smoothingFactor * previousMidSpectrum[i] + (1.0f - smoothingFactor) * midSpectrum[i];
-        previousMidSpectrum[i] = midSpectrum[i];
+        if (freq < referenceFrequency || freq > nyquist)
+            continue;
 
-        sideSpectrum[i] = smoothingFactor * previousSideSpectrum[i] + (1.0f - smoothingFactor) * sideSpectrum[i];
-        previousSideSpectrum[i] = sideSpectrum[i];
+        const int x = (int) frequencyToX(freq);
+        g.drawVerticalLine(x, 0.0f, static_cast<float>(height));
+        g.drawText(juce::String(freq) + " Hz", x + 2, height - 20, 50, 20, juce::Justification::left);
     }
 }
 
-
-void SpectrumAnalyzer::drawNextFrameOfSpectrum()
-{
-    // Not needed here as we process in pushBuffer
-}
-void SpectrumAnalyzer::drawFrame(juce::Graphics& g)
+float SpectrumAnalyzer::columnLevel(const std::vector<float>& decibels, const ColumnBins& column) const noexcept
 {
-    auto width = getLocalBounds().getWidth();
-    auto height = getLocalBounds().getHeight();
-
-    int numPoints = fftSize / 2;
-    double nyquist = processorRef.getSampleRate() * 0.5;
-    double binWidth = nyquist / numPoints;
-
-    juce::Path midPath;
-    juce::Path sidePath;
-
-    constexpr float minDecibels = -60.0f;
-    constexpr float maxDecibels = 100.0f;
-    constexpr float epsilon = 1e-12f;
-
-    double referenceFrequency = 40.0; // Reference frequency for calculating octaves
-
-    for (int i = 1; i < numPoints; ++i)
-    {
-        double frequency = i * binWidth;
-
-        // Avoid frequencies below the reference frequency
-        if (frequency < referenceFrequency)
-            continue;
+    if (column.numBins == 0)
+        return juce::jmap(column.fraction, decibels[(size_t) column.firstBin], decibels[(size_t) column.firstBin + 1]);
 
-        // Calculate the X position (logarithmic scaling)
-        double x = std::log10(frequency / referenceFrequency) / std::log10(nyquist / referenceFrequency) * width;
+    float level = decibels[(size_t) column.firstBin];
+    for (int i = 1; i < column.numBins; ++i)
+        level = juce::jmax(level, decibels[(size_t) (column.firstBin + i)]);
 
-        // Number of octaves above the reference frequency
-        double numOctaves = std::log2(frequency / referenceFrequency);
+    return level;
+}
 
-        // Slope adjustment in dB
-        double slopeAdjustment = numOctaves * 4.5; // 4.5 dB per octave
+void SpectrumAnalyzer::drawFrame(juce::Graphics& g)
+{
+    const auto& frame = analysisWorker.getLatestFrame();
 
-        // Mid magnitude
-        float midMagnitude = juce::Decibels::gainToDecibels(midSpectrum[i] + epsilon);
+    if ((int) frame.mid.size() != layoutNumBins || columns.size() != (size_t) getWidth())
+        return; // a new layout is on its way with the next timer tick
 
-        // Apply the slope adjustment
-        midMagnitude += static_cast<float>(slopeAdjustment);
+    // dB conversion and slope tilt for every bin, vectorised
+    constexpr float minimumGain = 1.0e-12f;
+    SIMDKernels::gainsToDecibels(frame.mid.data(), binTilt.data(), midDecibels.data(), layoutNumBins, minimumGain);
+    SIMDKernels::gainsToDecibels(frame.side.data(), binTilt.data(), sideDecibels.data(), layoutNumBins, minimumGain);
+    SIMDKernels::gainsToDecibels(frame.midPeak.data(), binTilt.data(), midPeakSpectrum.data(), layoutNumBins, minimumGain);
+    SIMDKernels::gainsToDecibels(frame.sidePeak.data(), binTilt.data(), sidePeakSpectrum.data(), layoutNumBins, minimumGain);
 
-        midMagnitude = juce::jlimit(minDecibels, maxDecibels, midMagnitude);
-        float yMid = juce::jmap(midMagnitude, minDecibels, maxDecibels, static_cast<float>(height), 0.0f);
+    const float height = static_cast<float>(getHeight());
 
-        if (i == 1)
-            midPath.startNewSubPath(static_cast<float>(x), yMid);
-        else
-            midPath.lineTo(static_cast<float>(x), yMid);
+    // One vertical run per pixel column, joining it to the previous column's level
+    auto drawColumns = [&] (const std::vector<float>& decibels, juce::Colour colour) {
+        g.setColour(colour);
+        float previousY = 0.0f;
 
-        // Side magnitude
-        float sideMagnitude = juce::Decibels::gainToDecibels(sideSpectrum[i] + epsilon);
+        for (size_t x = 0; x < columns.size(); ++x)
+        {
+            const float level = juce::jlimit(minDecibels, maxDecibels, columnLevel(decibels, columns[x]));
+            const float y = juce::jmap(level, minDecibels, maxDecibels, height, 0.0f);
 
-        // Apply the slope adjustment
-        sideMagnitude += static_cast<float>(slopeAdjustment);
+            if (x == 0)
+                previousY = y;
 
-        sideMagnitude = juce::jlimit(minDecibels, maxDecibels, sideMagnitude);
-        float ySide = juce::jmap(sideMagnitude, minDecibels, maxDecibels, static_cast<float>(height), 0.0f);
+            g.drawVerticalLine((int) x, juce::jmin(y, previousY), juce::jmax(y, previousY) + 1.0f);
+            previousY = y;
+        }
+    };
 
-        if (i == 1)
-            sidePath.startNewSubPath(static_cast<float>(x), ySide);
-        else
-            sidePath.lineTo(static_cast<float>(x), ySide);
-    }
+    // Peak hold, dimmed, behind the live curves
+    drawColumns(midPeakSpectrum, juce::Colours::red.withAlpha(0.35f));
+    drawColumns(sidePeakSpectrum, juce::Colours::blue.withAlpha(0.35f));
 
     // Draw mid spectrum (red)
-    g.setColour(juce::Colours::red);
-    g.strokePath(midPath, juce::PathStrokeType(1.0f));
+    drawColumns(midDecibels, juce::Colours::red);
 
     // Draw side spectrum (blue)
-    g.setColour(juce::Colours::blue);
-    g.strokePath(sidePath, juce::PathStrokeType(1.0f));
-
-    // Draw frequency markers
-    g.setColour(juce::Colours::grey);
-    std::vector<double> frequencies = { 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000 };
-    for (auto freq : frequencies)
-    {
-        if (freq < referenceFrequency || freq > nyquist)
-            continue;
-
-        double x = std::log10(freq / referenceFrequency) / std::log10(nyquist / referenceFrequency) * width;
-        g.drawVerticalLine(static_cast<int>(x), 0.0f, static_cast<float>(height));
-        g.drawText(juce::String(freq) + " Hz", static_cast<int>(x) + 2, height - 20, 50, 20, juce::Justification::left);
-    }
+    drawColumns(sideDecibels, juce::Colours::blue);
 }
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "PluginProcessor.h"
+#include "SpectrumAnalysisWorker.h"
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <juce_graphics/juce_graphics.h>
 #include <juce_dsp/juce_dsp.h>
@@ -15,55 +16,64 @@ class SpectrumAnalyzer : public juce::Component,
                          private juce::Timer
 {
 public:
-    SpectrumAnalyzer();
-    ~SpectrumAnalyzer() override;
     SpectrumAnalyzer(PluginProcessor& p);
+    ~SpectrumAnalyzer() override;
 
     void paint(juce::Graphics& g) override;
     void resized() override;
 
     void setVisualizerSmoothingValue(float val);
 
-    // Method to push audio data into the analyzer
-    void pushBuffer(const juce::AudioBuffer<float>& buffer);
-
-    void drawSpectrumPath(juce::Graphics& g, const std::vector<juce::Point<float>>& points);
-
 private:
 
     PluginProcessor& processorRef;
 
-    // FFT parameters
-    static constexpr int fftOrder = 10; // 2048-point FFT
-    static constexpr int fftSize = 1 << fftOrder;
-
-    juce::dsp::FFT forwardFFT;
-    juce::dsp::WindowingFunction<float> window;
-
-    // FIFO and buffers
-    std::array<float, fftSize> fifo;
-    std::array<float, fftSize * 2> fftData; // For real and imaginary parts
-    int fifoIndex = 0;
+    // FFTs and ballistics run on the worker; this component only draws its latest frame
+    SpectrumAnalysisWorker analysisWorker;
 
+    // Analyzer parameters, forwarded to the worker on each tick (never read in paint)
+    std::atomic<float>* fftSizeParameter = nullptr;
+    std::atomic<float>* overlapParameter = nullptr;
+    std::atomic<float>* smoothingParameter = nullptr;
 
-
-    bool nextFFTBlockReady = false;
-
-    // Visualization parameters
-    float visualizerSmoothingValue = 0.5f;
-
-    std::vector<float> midSpectrum;
-    std::vector<float> sideSpectrum;
-
+    // Held peaks in dB, drawn behind the live curves
     std::vector<float> midPeakSpectrum;
     std::vector<float> sidePeakSpectrum;
 
+    // Display range
+    static constexpr float minDecibels = -60.0f;
+    static constexpr float maxDecibels = 100.0f;
+    static constexpr double referenceFrequency = 40.0; // left edge of the log axis
+    static constexpr double slopePerOctave = 4.5; // dB of tilt per octave above it
+
+    // Bins that land in one pixel column: the loudest of several, or an
+    // interpolation between two where bins are wider than pixels
+    struct ColumnBins
+    {
+        int firstBin = 0;
+        int numBins = 0; // 0 = interpolate between firstBin and firstBin + 1
+        float fraction = 0.0f;
+    };
+
+    // Layout, rebuilt only when the size, analysis rate or FFT size changes
+    std::vector<ColumnBins> columns;
+    std::vector<float> binTilt;
+    std::vector<float> midDecibels, sideDecibels;
+    double layoutSampleRate = 0.0;
+    int layoutNumBins = 0;
+
+    // Black background plus frequency grid, at the display's pixel scale
+    juce::Image gridImage;
+    float gridScale = 0.0f;
 
     void timerCallback() override;
-    void drawNextFrameOfSpectrum();
-    void applySmoothing();
     void drawFrame(juce::Graphics& g);
 
+    void updateLayout(double sampleRate, int numBins);
+    void renderGrid(float scale);
+    float frequencyToX(double frequency) const noexcept;
+    float columnLevel(const std::vector<float>& decibels, const ColumnBins& column) const noexcept;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyzer)
 };
 
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+/**
+    Lock-free triple buffer: one writer thread publishes whole values of T, one
+    reader thread always gets the newest complete one. Neither side ever waits.
+
+    The writer fills getWriteBuffer() and calls publish(); the reader calls
+    update() and, when it returns true, reads getReadBuffer(). Each side owns one
+    slot; the third is swapped with whichever side finishes next, so a frame is
+    never read while being written, and the writer simply replaces any frame the
+    reader hasn't picked up yet.
+*/
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    /** Calls initialise on every slot (e.g. to allocate). Not thread safe: only
+        while neither side is running.
+    */
+    template <typename Function>
+    void prepare (Function&& initialise)
+    {
+        for (auto& slot : slots)
+            initialise (slot);
+
+        back = 0;
+        middle.store (1, std::memory_order_relaxed);
+        front = 2;
+    }
+
+    //==========================================================================
+    // Writer
+
+    T& getWriteBuffer() noexcept { return slots[(size_t) back]; }
+
+    /** Hands the write buffer over to the reader, taking the spare slot in exchange. */
+    void publish() noexcept
+    {
+        back = middle.exchange (back | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    //==========================================================================
+    // Reader
+
+    /** Picks up the newest published value, if there is one since the last call. */
+    bool update() noexcept
+    {
+        if ((middle.load (std::memory_order_relaxed) & freshBit) == 0)
+            return false;
+
+        front = middle.exchange (front, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const T& getReadBuffer() const noexcept { return slots[(size_t) front]; }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshBit = 4; ///< set in middle when it holds an unread value.
+
+    std::array<T, 3> slots;
+
+    int back = 0; ///< writer's slot.
+    std::atomic<int> middle { 1 }; ///< the spare slot, plus freshBit.
+    int front = 2; ///< reader's slot.
+};
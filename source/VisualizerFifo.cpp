@@ -0,0 +1,172 @@
+#include "VisualizerFifo.h"
+
+#include <algorithm>
+#include <cmath>
+
+//==============================================================================
+void VisualizerFifo::allocate (int newFrameSize, int minimumFrames)
+{
+    const juce::ScopedLock lock (consumerLock);
+
+    frameSize = juce::jmax (1, newFrameSize);
+    capacity = (uint32_t) juce::nextPowerOfTwo (juce::jmax (2, minimumFrames));
+    mask = capacity - 1;
+    storage.assign ((size_t) capacity * (size_t) frameSize, 0.0f);
+
+    writePosition.store (0, std::memory_order_relaxed);
+    readPosition.store (0, std::memory_order_relaxed);
+}
+
+void VisualizerFifo::prepareForAudio (double hostSampleRate, double bufferSeconds)
+{
+    // Integer decimation down to at most maxAnalysisRate (1x at 44.1/48 kHz, 2x at 88.2/96 kHz, ...)
+    decimation = juce::jmax (1, (int) std::ceil (hostSampleRate / maxAnalysisRate - 1.0e-6));
+    analysisRate.store (hostSampleRate / decimation, std::memory_order_relaxed);
+    decimationCount = 0;
+    midSum = sideSum = 0.0f;
+
+    allocate (2, (int) std::ceil (getSampleRate() * bufferSeconds));
+}
+
+void VisualizerFifo::prepareForSpectrum (int newFrameSize, int numFrames)
+{
+    decimation = 1;
+    allocate (newFrameSize, numFrames);
+}
+
+void VisualizerFifo::setConsumerActive (bool isActive) noexcept
+{
+    const juce::ScopedLock lock (consumerLock);
+
+    // Anything left from before the consumer attached is stale: skip it
+    if (isActive)
+        readPosition.store (writePosition.load (std::memory_order_acquire), std::memory_order_release);
+
+    consumerActive.store (isActive, std::memory_order_relaxed);
+}
+
+void VisualizerFifo::resetCounters() noexcept
+{
+    overruns.store (0, std::memory_order_relaxed);
+    underruns.store (0, std::memory_order_relaxed);
+}
+
+//==============================================================================
+void VisualizerFifo::pushAudio (const juce::AudioBuffer<float>& buffer) noexcept
+{
+    if (! isConsumerActive() || capacity == 0 || frameSize != 2)
+        return;
+
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = buffer.getNumChannels();
+
+    if (numChannels == 0)
+        return;
+
+    const float* left = buffer.getReadPointer (0);
+    const float* right = numChannels > 1 ? buffer.getReadPointer (1) : nullptr;
+
+    const uint32_t write = writePosition.load (std::memory_order_relaxed);
+    const uint32_t space = capacity - (write - readPosition.load (std::memory_order_acquire));
+    const float scale = 0.5f / (float) decimation; // mid/side halves, then the boxcar average
+
+    uint32_t produced = 0;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        // Mono has no side; extra channels beyond the first two are ignored
+        const float l = left[i];
+        const float r = right != nullptr ? right[i] : l;
+        midSum += l + r;
+        sideSum += l - r;
+
+        if (++decimationCount < decimation)
+            continue;
+
+        if (produced == space)
+        {
+            // Full: drop the rest of the block rather than overwrite unread data
+            overruns.fetch_add (1, std::memory_order_relaxed);
+            decimationCount = 0;
+            midSum = sideSum = 0.0f;
+            break;
+        }
+
+        float* frame = storage.data() + (size_t) ((write + produced) & mask) * 2;
+        frame[0] = midSum * scale;
+        frame[1] = sideSum * scale;
+        ++produced;
+
+        decimationCount = 0;
+        midSum = sideSum = 0.0f;
+    }
+
+    writePosition.store (write + produced, std::memory_order_release);
+}
+
+void VisualizerFifo::pushFrame (const float* frame) noexcept
+{
+    if (! isConsumerActive() || capacity == 0)
+        return;
+
+    const uint32_t write = writePosition.load (std::memory_order_relaxed);
+
+    if (write - readPosition.load (std::memory_order_acquire) == capacity)
+    {
+        overruns.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    std::copy_n (frame, frameSize, storage.data() + (size_t) (write & mask) * (size_t) frameSize);
+    writePosition.store (write + 1, std::memory_order_release);
+}
+
+//==============================================================================
+int VisualizerFifo::getNumReady() const noexcept
+{
+    return (int) (writePosition.load (std::memory_order_acquire) - readPosition.load (std::memory_order_relaxed));
+}
+
+bool VisualizerFifo::pullMidSide (float* mid, float* side, int numSamples) noexcept
+{
+    jassert (frameSize == 2);
+    return read (mid, side, numSamples);
+}
+
+bool VisualizerFifo::pullFrame (float* frame) noexcept
+{
+    return read (frame, nullptr, 1);
+}
+
+bool VisualizerFifo::read (float* first, float* second, int numFrames) noexcept
+{
+    const juce::ScopedLock lock (consumerLock);
+
+    const uint32_t start = readPosition.load (std::memory_order_relaxed);
+    const uint32_t available = writePosition.load (std::memory_order_acquire) - start;
+
+    if (capacity == 0 || available < (uint32_t) numFrames)
+    {
+        underruns.fetch_add (1, std::memory_order_relaxed);
+        return false;
+    }
+
+    for (int i = 0; i < numFrames; ++i)
+    {
+        const float* frame = storage.data() + (size_t) ((start + (uint32_t) i) & mask) * (size_t) frameSize;
+
+        if (second != nullptr)
+        {
+            // Mid/side pairs: split into the two destinations
+            first[i] = frame[0];
+            second[i] = frame[1];
+        }
+        else
+        {
+            std::copy_n (frame, frameSize, first + (size_t) i * (size_t) frameSize);
+        }
+    }
+
+    readPosition.store (start + (uint32_t) numFrames, std::memory_order_release);
+    return true;
+}
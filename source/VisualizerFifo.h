@@ -0,0 +1,107 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+    Lock-free single-producer / single-consumer transport from the audio thread
+    to the visualizer.
+
+    The ring holds fixed-size frames of floats, in one of two formats:
+    - audio: one (mid, side) pair per frame, built from any channel count (mono
+      has no side) and decimated to at most maxAnalysisRate, so high host rates
+      don't cost the visualizer more than 48 kHz would;
+    - spectrum: whole frames of frameSize values (e.g. magnitudes computed on the
+      producer side), pushed and pulled atomically.
+
+    The producer never blocks: when the ring is full the new data is dropped and
+    counted as an overrun. A pull that finds too little data returns false and
+    counts an underrun. While no consumer is attached, pushes return straight
+    away, so a closed editor costs the audio thread nothing.
+
+    prepare*() allocate, and must not run concurrently with pushes (call them from
+    prepareToPlay). They may run while a consumer is attached: the consumer side
+    shares a lock with them, which the producer never takes.
+*/
+class VisualizerFifo
+{
+public:
+    static constexpr double maxAnalysisRate = 48000.0;
+
+    VisualizerFifo() = default;
+
+    //==========================================================================
+    /** Sizes the ring for mid/side audio: bufferSeconds of the decimated stream. */
+    void prepareForAudio (double hostSampleRate, double bufferSeconds = 0.5);
+
+    /** Sizes the ring for numFrames whole spectrum frames of frameSize values. */
+    void prepareForSpectrum (int frameSize, int numFrames);
+
+    /** Marks a consumer (editor) as attached; attaching discards anything stale. */
+    void setConsumerActive (bool isActive) noexcept;
+    bool isConsumerActive() const noexcept { return consumerActive.load (std::memory_order_relaxed); }
+
+    /** The rate of the (decimated) mid/side stream. */
+    double getSampleRate() const noexcept { return analysisRate.load (std::memory_order_relaxed); }
+    int getFrameSize() const noexcept { return frameSize; }
+
+    //==========================================================================
+    // Producer (audio thread)
+
+    /** Pushes the block as decimated mid/side pairs. */
+    void pushAudio (const juce::AudioBuffer<float>& buffer) noexcept;
+
+    /** Pushes one whole frame of getFrameSize() values. */
+    void pushFrame (const float* frame) noexcept;
+
+    //==========================================================================
+    // Consumer
+
+    /** Number of whole frames (mid/side pairs, or spectrum frames) waiting. */
+    int getNumReady() const noexcept;
+
+    /** Reads exactly numSamples mid/side pairs, or nothing if fewer are waiting. */
+    bool pullMidSide (float* mid, float* side, int numSamples) noexcept;
+
+    /** Reads one whole spectrum frame, or nothing if none is waiting. */
+    bool pullFrame (float* frame) noexcept;
+
+    //==========================================================================
+    // Diagnostics
+
+    uint32_t getNumOverruns() const noexcept { return overruns.load (std::memory_order_relaxed); }
+    uint32_t getNumUnderruns() const noexcept { return underruns.load (std::memory_order_relaxed); }
+    void resetCounters() noexcept;
+
+private:
+    //==========================================================================
+    void allocate (int newFrameSize, int minimumFrames);
+
+    // Read side: copies numFrames frames out, deinterleaving into up to two destinations
+    bool read (float* first, float* second, int numFrames) noexcept;
+
+    juce::CriticalSection consumerLock; ///< consumer vs. prepare*(), never the producer.
+
+    std::vector<float> storage;
+    int frameSize = 2;
+    uint32_t capacity = 0; ///< in frames, a power of two.
+    uint32_t mask = 0;
+
+    // Mid/side decimation (producer state)
+    std::atomic<double> analysisRate { maxAnalysisRate }; ///< read by the consumer thread.
+    int decimation = 1;
+    int decimationCount = 0;
+    float midSum = 0.0f, sideSum = 0.0f;
+
+    // Frame counters; they only ever grow (and wrap), so full and empty differ
+    alignas (64) std::atomic<uint32_t> writePosition { 0 };
+    alignas (64) std::atomic<uint32_t> readPosition { 0 };
+
+    alignas (64) std::atomic<bool> consumerActive { false };
+    std::atomic<uint32_t> overruns { 0 }, underruns { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VisualizerFifo)
+};
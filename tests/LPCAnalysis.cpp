@@ -0,0 +1,261 @@
+#include <Autocorrelator.h>
+#include <LPCProcessor.h>
+#include <PackedStereoFFT.h>
+#include <PitchTracker.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    /** Two different, Hann-windowed test frames: harmonics plus a little noise. */
+    void fillStereoFrames (std::vector<float>& left, std::vector<float>& right)
+    {
+        juce::Random random (3);
+        const auto length = (int) left.size();
+
+        for (int n = 0; n < length; ++n)
+        {
+            const float window = 0.5f * (1.0f - std::cos (2.0f * juce::MathConstants<float>::pi * (float) n / (float) length));
+            const float noise = 0.02f * (random.nextFloat() * 2.0f - 1.0f);
+
+            left[(size_t) n] = window * (0.5f * std::sin (0.07f * (float) n) + 0.2f * std::sin (0.21f * (float) n) + noise);
+            right[(size_t) n] = window * (0.4f * std::sin (0.13f * (float) n) + 0.1f * std::sin (0.52f * (float) n) - noise);
+        }
+    }
+
+    /** Feeds a 100 Hz sawtooth-like tone to a tracker hop by hop, the way LPCProcessor does,
+        and returns the last estimate.
+    */
+    PitchTracker::Estimate trackTone (double sampleRate, float frequency)
+    {
+        constexpr int windowSize = 512;
+        constexpr int hopSize = windowSize / 2;
+        constexpr int numHops = 40;
+
+        PitchTracker tracker;
+        tracker.prepare (windowSize, sampleRate);
+        tracker.setSampleRate (sampleRate);
+
+        Autocorrelator autocorrelator;
+        autocorrelator.prepare (windowSize);
+
+        std::vector<float> input ((size_t) (numHops * hopSize));
+
+        for (size_t n = 0; n < input.size(); ++n)
+        {
+            const double phase = 2.0 * juce::MathConstants<double>::pi * frequency * (double) n / sampleRate;
+
+            for (int h = 1; h <= 6; ++h)
+                input[n] += (float) (std::sin (h * phase) / h);
+        }
+
+        std::vector<float> frame (windowSize), lags (windowSize + 1);
+        PitchTracker::Estimate estimate;
+
+        for (int hop = 1; hop < numHops; ++hop)
+        {
+            const float* hopStart = input.data() + (hop - 1) * hopSize;
+            tracker.pushSamples (hopStart, hopSize);
+
+            if (tracker.needsOwnFrames())
+            {
+                estimate = tracker.processHistory();
+                continue;
+            }
+
+            if (hop * hopSize < windowSize)
+                continue;
+
+            // Short enough periods: the Hann-windowed LPC frame and its autocorrelation
+            const float* frameStart = input.data() + hop * hopSize - windowSize;
+
+            for (int n = 0; n < windowSize; ++n)
+                frame[(size_t) n] = frameStart[n] * 0.5f * (1.0f - std::cos (2.0f * juce::MathConstants<float>::pi * (float) n / (float) windowSize));
+
+            autocorrelator.compute (frame.data(), windowSize, tracker.getMaxLag(), lags.data());
+            estimate = tracker.process (frame.data(), windowSize, lags.data());
+        }
+
+        return estimate;
+    }
+
+    std::vector<float> renderStereo (bool packStereo)
+    {
+        constexpr int blockSize = 256;
+        constexpr int numBlocks = 64;
+
+        LPCProcessor processor (16, 512);
+        processor.setStereoPackingEnabled (packStereo);
+        processor.setAutocorrelationMethod (Autocorrelator::Method::fft);
+        processor.setPitchDetectionEnabled (true);
+        processor.prepare (48000.0, blockSize, 2);
+
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        juce::Random random (5);
+        std::vector<float> rendered;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            // Tones plus a little noise: pure tones give near-singular models whose
+            // resonances amplify FFT rounding differences far beyond what's being tested
+            for (int i = 0; i < blockSize; ++i)
+            {
+                const auto t = (float) (block * blockSize + i);
+                buffer.setSample (0, i, 0.5f * std::sin (0.06f * t) + 0.05f * (random.nextFloat() * 2.0f - 1.0f));
+                buffer.setSample (1, i, 0.3f * std::sin (0.11f * t) + 0.1f * std::sin (0.4f * t) + 0.05f * (random.nextFloat() * 2.0f - 1.0f));
+            }
+
+            processor.process (buffer, buffer);
+
+            for (int ch = 0; ch < 2; ++ch)
+                rendered.insert (rendered.end(), buffer.getReadPointer (ch), buffer.getReadPointer (ch) + blockSize);
+        }
+
+        return rendered;
+    }
+
+    /** Streams a mono signal through a stereo LPCProcessor in blocks of blockSize,
+        returning the left output. The right channel gets an inverted, quieter copy.
+    */
+    std::vector<float> renderInBlocks (const std::vector<float>& input, int blockSize, int& latency)
+    {
+        LPCProcessor processor (16, 512);
+        processor.setPitchDetectionEnabled (true);
+        processor.prepare (48000.0, blockSize, 2);
+        latency = processor.getLatencySamples();
+
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        std::vector<float> rendered;
+        const auto length = (int) input.size();
+
+        for (int position = 0; position < length; position += blockSize)
+        {
+            const int numSamples = juce::jmin (blockSize, length - position);
+            buffer.setSize (2, numSamples, false, false, true);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                buffer.setSample (0, i, input[(size_t) (position + i)]);
+                buffer.setSample (1, i, -0.5f * input[(size_t) (position + i)]);
+            }
+
+            processor.process (buffer, buffer);
+            rendered.insert (rendered.end(), buffer.getReadPointer (0), buffer.getReadPointer (0) + numSamples);
+        }
+
+        return rendered;
+    }
+}
+
+TEST_CASE ("Packed stereo FFT matches per-channel analysis", "[lpc]")
+{
+    constexpr int length = 512;
+    constexpr int maxLag = 24;
+
+    std::vector<float> left (length), right (length);
+    fillStereoFrames (left, right);
+
+    PackedStereoFFT packed;
+    packed.prepare (length);
+
+    std::vector<float> packedLeft (maxLag + 1), packedRight (maxLag + 1);
+    packed.computeAutocorrelations (left.data(), right.data(), length, maxLag, packedLeft.data(), packedRight.data());
+
+    std::vector<float> directLeft (maxLag + 1), directRight (maxLag + 1);
+    Autocorrelator::computeDirect (left.data(), length, maxLag, directLeft.data());
+    Autocorrelator::computeDirect (right.data(), length, maxLag, directRight.data());
+
+    for (int k = 0; k <= maxLag; ++k)
+    {
+        CHECK_THAT (packedLeft[(size_t) k], Catch::Matchers::WithinAbs (directLeft[(size_t) k], 1.0e-4 * directLeft[0]));
+        CHECK_THAT (packedRight[(size_t) k], Catch::Matchers::WithinAbs (directRight[(size_t) k], 1.0e-4 * directRight[0]));
+    }
+}
+
+TEST_CASE ("Stereo packing leaves LPCProcessor output unchanged", "[lpc]")
+{
+    const auto perChannel = renderStereo (false);
+    const auto packed = renderStereo (true);
+
+    REQUIRE (perChannel.size() == packed.size());
+
+    float peak = 0.0f;
+    for (auto sample : perChannel)
+        peak = std::max (peak, std::abs (sample));
+
+    REQUIRE (peak > 0.0f);
+
+    for (size_t i = 0; i < perChannel.size(); ++i)
+        REQUIRE_THAT (packed[i], Catch::Matchers::WithinAbs (perChannel[i], 1.0e-3 * peak));
+}
+
+TEST_CASE ("LPCProcessor output doesn't depend on the block size", "[lpc]")
+{
+    constexpr int length = 3 * 8192;
+
+    std::vector<float> input (length);
+    juce::Random random (7);
+
+    for (int n = 0; n < length; ++n)
+        input[(size_t) n] = 0.5f * std::sin (0.05f * (float) n) + 0.2f * std::sin (0.31f * (float) n)
+                            + 0.05f * (random.nextFloat() * 2.0f - 1.0f);
+
+    int latency = 0;
+    const auto reference = renderInBlocks (input, 512, latency);
+
+    for (const int blockSize : { 1, 17, 8192 })
+    {
+        INFO ("Block size " << blockSize);
+        const auto rendered = renderInBlocks (input, blockSize, latency);
+
+        REQUIRE (rendered.size() == reference.size());
+        REQUIRE (std::equal (rendered.begin(), rendered.end(), reference.begin()));
+    }
+}
+
+TEST_CASE ("LPCProcessor output arrives after its reported latency", "[lpc]")
+{
+    constexpr int windowSize = 512;
+    constexpr int impulsePosition = 4096;
+
+    std::vector<float> input (4 * impulsePosition, 0.0f);
+    input[impulsePosition] = 1.0f;
+
+    int latency = 0;
+    const auto rendered = renderInBlocks (input, 256, latency);
+
+    // Resynthesis spreads the impulse over the frames that saw it, so nothing may
+    // come out before the earliest of them, one window ahead of the latency...
+    for (int n = 0; n < impulsePosition + latency - windowSize; ++n)
+        REQUIRE (std::abs (rendered[(size_t) n]) < 1.0e-3f);
+
+    // ...and the energy is centred on the impulse delayed by exactly the latency
+    double energy = 0.0, weightedTime = 0.0;
+
+    for (size_t n = 0; n < rendered.size(); ++n)
+    {
+        const double power = (double) rendered[n] * (double) rendered[n];
+        energy += power;
+        weightedTime += power * (double) n;
+    }
+
+    REQUIRE (energy > 0.0);
+    CHECK_THAT (weightedTime / energy, Catch::Matchers::WithinAbs (impulsePosition + latency, windowSize / 8));
+}
+
+TEST_CASE ("Pitch tracker follows 100 Hz at any sample rate", "[lpc]")
+{
+    // A 512-sample window alone only reaches ~190 Hz at 48 kHz
+    for (const double sampleRate : { 8000.0, 16000.0, 48000.0 })
+    {
+        INFO ("sample rate " << sampleRate);
+
+        const auto estimate = trackTone (sampleRate, 100.0f);
+        REQUIRE (estimate.confidence > 0.0f);
+        REQUIRE_THAT (estimate.frequency, Catch::Matchers::WithinRel (100.0f, 0.01f));
+    }
+}
@@ -0,0 +1,101 @@
+#include <LPCSynthesisFilter.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    /** Random reflection coefficients shaped like analysed speech: |k| <= 0.9, so the
+        filter is stable, with the higher ones smaller. (Uniformly large ones make the
+        conversions ill-conditioned in float at high orders, on any implementation.)
+    */
+    std::vector<float> randomReflection (int order, int seed)
+    {
+        juce::Random random (seed);
+        std::vector<float> reflection ((size_t) order);
+        float bound = 0.9f;
+
+        for (auto& k : reflection)
+        {
+            k = bound * (random.nextFloat() * 2.0f - 1.0f);
+            bound *= 0.85f;
+        }
+
+        return reflection;
+    }
+
+    /** Runs the excitation through one structure, in calls of varying length so the
+        state has to carry over between them.
+    */
+    std::vector<float> synthesize (LPCSynthesisFilter::Structure structure, const std::vector<float>& reflection, const std::vector<float>& excitation)
+    {
+        LPCSynthesisFilter filter;
+        filter.setStructure (structure);
+        filter.setReflectionCoefficients (reflection.data(), (int) reflection.size());
+
+        std::vector<float> output (excitation.size());
+        const int callLengths[] = { 1, 3, 17, 64, 200 };
+        int position = 0;
+
+        for (int call = 0; position < (int) excitation.size(); ++call)
+        {
+            const int length = std::min (callLengths[call % 5], (int) excitation.size() - position);
+            filter.process (excitation.data() + position, output.data() + position, length, 0.5f);
+            position += length;
+        }
+
+        return output;
+    }
+}
+
+TEST_CASE ("Direct form and lattice synthesize the same signal", "[lpc]")
+{
+    juce::Random random (5);
+    std::vector<float> excitation (2048);
+
+    for (auto& x : excitation)
+        x = random.nextFloat() * 2.0f - 1.0f;
+
+    for (const int order : { 1, 2, 10, LPCSynthesisFilter::maxOrder })
+    {
+        INFO ("order " << order);
+
+        const auto reflection = randomReflection (order, order);
+        const auto direct = synthesize (LPCSynthesisFilter::Structure::directForm, reflection, excitation);
+        const auto lattice = synthesize (LPCSynthesisFilter::Structure::lattice, reflection, excitation);
+
+        // Resonant filters can have a lot of gain, so compare relative to the peak
+        float peak = 0.0f;
+
+        for (const auto y : direct)
+            peak = std::max (peak, std::abs (y));
+
+        for (size_t i = 0; i < direct.size(); ++i)
+            REQUIRE_THAT (lattice[i], Catch::Matchers::WithinAbs (direct[i], 1.0e-4f * peak));
+    }
+}
+
+TEST_CASE ("Reflection and direct-form coefficients convert both ways", "[lpc]")
+{
+    for (const int order : { 1, 2, 10, LPCSynthesisFilter::maxOrder })
+    {
+        INFO ("order " << order);
+
+        const auto reflection = randomReflection (order, 100 + order);
+        std::vector<float> lpc ((size_t) order), roundTrip ((size_t) order), lpcRoundTrip ((size_t) order);
+
+        LPCSynthesisFilter::reflectionToLpc (reflection.data(), order, lpc.data());
+        LPCSynthesisFilter::lpcToReflection (lpc.data(), order, roundTrip.data());
+
+        for (size_t i = 0; i < reflection.size(); ++i)
+            REQUIRE_THAT (roundTrip[i], Catch::Matchers::WithinAbs (reflection[i], 1.0e-4f));
+
+        LPCSynthesisFilter::reflectionToLpc (roundTrip.data(), order, lpcRoundTrip.data());
+
+        for (size_t i = 0; i < lpc.size(); ++i)
+            REQUIRE_THAT (lpcRoundTrip[i], Catch::Matchers::WithinAbs (lpc[i], 1.0e-3f * std::max (1.0f, std::abs (lpc[i]))));
+    }
+}
@@ -0,0 +1,230 @@
+#include "helpers/RealtimeChecker.h"
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+    float* volatile allocationSink = nullptr;
+
+    void setParameter (PluginProcessor& plugin, const char* parameterID, float value)
+    {
+        auto* parameter = plugin.apvts.getParameter (parameterID);
+        parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+
+    /** A parameter and the values the sweep tries for it. */
+    struct Sweep
+    {
+        const char* parameterID;
+        std::vector<float> values;
+    };
+
+    /** Stands in for a host, so the notification paths run with someone listening. */
+    struct HostListener : public juce::AudioProcessorListener
+    {
+        void audioProcessorParameterChanged (juce::AudioProcessor*, int, float) override {}
+        void audioProcessorChanged (juce::AudioProcessor*, const ChangeDetails&) override {}
+    };
+}
+
+TEST_CASE ("Realtime checker catches violations", "[realtime]")
+{
+    if (! RealtimeRegion::isEnabled())
+    {
+        WARN ("The realtime checker is disabled in sanitizer builds");
+        return;
+    }
+
+    RealtimeRegion clean;
+    std::vector<float> samples (64, 0.5f);
+    clean.run ([&] {
+        for (auto& sample : samples)
+            sample *= 0.5f;
+    });
+
+    CHECK (clean.getNumViolations() == 0);
+    CHECK (clean.getReport().empty());
+
+    RealtimeRegion allocating;
+    allocating.run ([] {
+        allocationSink = new float[64];
+        delete[] allocationSink;
+    });
+
+    CHECK (allocating.getNumViolations() == 2);
+    CHECK (allocating.getReport().find ("operator new[]") != std::string::npos);
+
+    if (RealtimeRegion::checksSystemCalls())
+    {
+        juce::CriticalSection lock;
+        RealtimeRegion locking;
+        locking.run ([&] { const juce::ScopedLock scopedLock (lock); });
+
+        CHECK (locking.getNumViolations() == 1);
+        CHECK (locking.getReport().find ("pthread_mutex_lock") != std::string::npos);
+    }
+}
+
+TEST_CASE ("processBlock is realtime safe", "[realtime]")
+{
+    if (! RealtimeRegion::isEnabled())
+    {
+        WARN ("The realtime checker is disabled in sanitizer builds");
+        return;
+    }
+
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int maxBlockSize = 512;
+    const int blockSizes[] = { 1, 17, 64, 128, 480, 512 };
+
+    // Automated while playing: every combination of the switches and of the ends
+    // of each range that picks a different code path
+    const std::vector<Sweep> switches = {
+        { "BYPASS", { 0.0f, 1.0f } },
+        { "PITCH_DETECTION", { 0.0f, 1.0f } },
+        { "LPC_SAMPLE_RATE", { 4000.0f, 48000.0f } },
+        { "LPC_ORDER", { 1.0f, 24.0f } },
+        { "BIT_DEPTH", { 1.0f, 24.0f } },
+        { "REDUX_RATE", { 1000.0f, 96000.0f } },
+        { "DITHER", { 0.0f, 1.0f } },
+        { "NOISE_SHAPING", { 0.0f, 1.0f } },
+        { "REDUX_ANTI_ALIAS", { 0.0f, 1.0f } },
+    };
+
+    // Smoothed ranges: stepped through alongside (bottom, default, top)
+    const std::vector<Sweep> ranges = {
+        { "IN", { -60.0f, 0.0f, 10.0f } },
+        { "OUT", { -60.0f, 0.0f, 10.0f } },
+        { "OVERALL_MIX", { 0.0f, 50.0f, 100.0f } },
+        { "LPC_ALPHA", { 0.01f, 0.95f, 1.0f } },
+    };
+
+    int numCombinations = 1;
+    for (const auto& sweep : switches)
+        numCombinations *= (int) sweep.values.size();
+
+    // Oversampling is applied in prepareToPlay, so each setting gets its own pass
+    struct Setup
+    {
+        int oversamplingIndex;
+        bool linearPhase;
+    };
+
+    const Setup setups[] = { { 0, false }, { 1, false }, { 1, true }, { 2, false }, { 2, true }, { 3, false }, { 3, true } };
+
+    PluginProcessor plugin;
+    HostListener host;
+    plugin.addListener (&host);
+
+    juce::AudioBuffer<float> buffer (2, maxBlockSize);
+    juce::MidiBuffer midi;
+    int sampleClock = 0;
+
+    // What each switch was last set to (nothing yet), to spot a new LPC config
+    const auto& engines = plugin.getLPCEngineManager();
+    std::vector<float> lastValues (switches.size(), -1.0f);
+
+    const auto describe = [&] (const Setup& setup, int blockSize) {
+        std::string description = "Oversampling index " + std::to_string (setup.oversamplingIndex)
+                                  + (setup.linearPhase ? " (linear phase)" : "")
+                                  + ", block size " + std::to_string (blockSize);
+
+        for (const auto& sweep : switches)
+            description += std::string (", ") + sweep.parameterID + " = "
+                           + std::to_string (plugin.apvts.getRawParameterValue (sweep.parameterID)->load());
+
+        return description;
+    };
+
+    for (const auto& setup : setups)
+    {
+        setParameter (plugin, "OVERSAMPLING", (float) setup.oversamplingIndex);
+        setParameter (plugin, "OVERSAMPLING_LINEAR_PHASE", setup.linearPhase ? 1.0f : 0.0f);
+        plugin.setRateAndBufferSizeDetails (sampleRate, maxBlockSize);
+        plugin.prepareToPlay (sampleRate, maxBlockSize);
+
+        for (int combination = 0; combination < numCombinations; ++combination)
+        {
+            // Parameter changes go through the APVTS listeners (which may allocate),
+            // so they're made outside the region, like a host's automation thread
+            bool lpcConfigChanged = false;
+
+            for (int index = 0, remaining = combination; index < (int) switches.size(); ++index)
+            {
+                const auto& sweep = switches[(size_t) index];
+                const float value = sweep.values[(size_t) remaining % sweep.values.size()];
+                remaining /= (int) sweep.values.size();
+
+                const std::string parameterID = sweep.parameterID;
+
+                if ((parameterID == "LPC_SAMPLE_RATE" || parameterID == "LPC_ORDER") && value != lastValues[(size_t) index])
+                    lpcConfigChanged = true;
+
+                lastValues[(size_t) index] = value;
+                setParameter (plugin, sweep.parameterID, value);
+            }
+
+            for (const auto& sweep : ranges)
+                setParameter (plugin, sweep.parameterID, sweep.values[(size_t) combination % sweep.values.size()]);
+
+            const int blockSize = blockSizes[(size_t) combination % std::size (blockSizes)];
+            buffer.setSize (2, blockSize, false, false, true);
+
+            RealtimeRegion region;
+            const auto processNextBlock = [&] {
+                for (int i = 0; i < blockSize; ++i, ++sampleClock)
+                {
+                    const float sample = 0.25f * std::sin (0.031f * (float) sampleClock);
+                    buffer.setSample (0, i, sample);
+                    buffer.setSample (1, i, -sample);
+                }
+
+                region.run ([&] { plugin.processBlock (buffer, midi); });
+            };
+
+            // Two blocks: the one that picks up the change, and one in the new steady state
+            processNextBlock();
+            processNextBlock();
+
+            // A new LPC rate or order builds a new engine in the background (only ever
+            // swapped in while the wet path runs). Wait for it outside the region, then
+            // check the whole handover: warm-up, crossfade and retiring the old engine.
+            if (lpcConfigChanged && plugin.apvts.getRawParameterValue ("BYPASS")->load() < 0.5f)
+            {
+                const auto deadline = juce::Time::getMillisecondCounter() + 5000;
+
+                while (! engines.isIncomingEngineReady() && ! engines.isSwitching())
+                {
+                    if (juce::Time::getMillisecondCounter() > deadline)
+                        FAIL ("No engine was built for the new LPC config\n" << describe (setup, blockSize));
+
+                    juce::Thread::sleep (1);
+                }
+
+                processNextBlock(); // starts the switch (if the last one didn't already)
+
+                for (int processed = 0; engines.isSwitching(); processed += blockSize)
+                {
+                    if (processed > (int) sampleRate)
+                        FAIL ("The engine switch didn't finish within a second\n" << describe (setup, blockSize));
+
+                    processNextBlock();
+                }
+            }
+
+            if (region.getNumViolations() > 0)
+                FAIL (describe (setup, blockSize) << "\n" << region.getReport());
+        }
+
+        plugin.releaseResources();
+    }
+
+    plugin.removeListener (&host);
+}
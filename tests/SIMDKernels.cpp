@@ -0,0 +1,84 @@
+#include <ReduxProcessor.h>
+#include <SIMDKernels.h>
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    std::vector<float> randomBlock (int length, float range, int seed)
+    {
+        juce::Random random (seed);
+        std::vector<float> block ((size_t) length);
+
+        for (auto& x : block)
+            x = range * (random.nextFloat() * 2.0f - 1.0f);
+
+        return block;
+    }
+}
+
+TEST_CASE ("AVX2 quantizer matches the default one", "[simd]")
+{
+    if (! ReduxProcessor::hasAVX2Quantizer())
+    {
+        WARN ("No AVX2 quantizer in this build or on this CPU");
+        return;
+    }
+
+    // Odd lengths leave a tail for the scalar loop after the vector body
+    for (const int length : { 1, 7, 8, 9, 31, 256, 1003 })
+    {
+        // Whole bit depths give power-of-two steps, so the scaling is exact and the
+        // fused multiply-add rounds exactly like the separate multiply and add
+        for (const float bitDepth : { 1.0f, 4.0f, 8.0f, 16.0f, 23.0f })
+        {
+            const float step = std::exp2 (1.0f - bitDepth);
+            const auto input = randomBlock (length, 1.0f, length);
+            const auto dither = randomBlock (length, 1.0f, length + 1);
+
+            for (const bool dithered : { false, true })
+            {
+                INFO ("length " << length << ", bits " << bitDepth << (dithered ? ", dithered" : ""));
+
+                auto expected = input;
+                auto actual = input;
+                const float* offsets = dithered ? dither.data() : nullptr;
+
+                ReduxProcessor::quantizeDefault (expected.data(), length, step, 1.0f / step, offsets);
+                ReduxProcessor::quantizeAVX2 (actual.data(), length, step, 1.0f / step, offsets);
+
+                for (int i = 0; i < length; ++i)
+                    REQUIRE (actual[(size_t) i] == expected[(size_t) i]);
+            }
+        }
+    }
+}
+
+TEST_CASE ("Vectorised noise matches the scalar hash", "[simd]")
+{
+    // Whichever integer lanes this build compiles (AVX2, SSE4.1, NEON or none)
+    // must reproduce hashNoise() bit for bit, including across index wrap-around
+    constexpr float scale = 2.0f / 16777216.0f;
+
+    for (const uint32_t seed : { 0u, 1u, 0xdeadbeefu })
+    {
+        for (const uint32_t firstIndex : { 0u, 5u, 0xfffffff3u })
+        {
+            for (const int length : { 1, 3, 4, 5, 8, 13, 64, 257 })
+            {
+                INFO ("seed " << seed << ", first index " << firstIndex << ", length " << length);
+
+                std::vector<float> noise ((size_t) length);
+                SIMDKernels::fillUniformNoise (noise.data(), length, seed, firstIndex);
+
+                for (int i = 0; i < length; ++i)
+                {
+                    const auto hash = SIMDKernels::hashNoise (seed, firstIndex + (uint32_t) i);
+                    REQUIRE (noise[(size_t) i] == (float) (hash >> 8) * scale - 1.0f);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,335 @@
+#include "RealtimeChecker.h"
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#if defined(_MSC_VER)
+    #include <malloc.h>
+#endif
+
+// Sanitizers install their own allocator and interceptors: leave them alone
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+    #define BYTEMARK_REALTIME_CHECKER_SANITIZED 1
+#elif defined(__has_feature)
+    #if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || __has_feature(memory_sanitizer)
+        #define BYTEMARK_REALTIME_CHECKER_SANITIZED 1
+    #endif
+#endif
+
+#ifndef BYTEMARK_REALTIME_CHECKER_SANITIZED
+    #define BYTEMARK_REALTIME_CHECKER_SANITIZED 0
+#endif
+
+// glibc lets the executable replace malloc and friends and the pthread entry points
+#if ! BYTEMARK_REALTIME_CHECKER_SANITIZED && defined(__linux__) && defined(__GLIBC__)
+    #define BYTEMARK_REALTIME_CHECKER_GLIBC 1
+    #include <dlfcn.h>
+    #include <pthread.h>
+    #include <time.h>
+#else
+    #define BYTEMARK_REALTIME_CHECKER_GLIBC 0
+#endif
+
+namespace
+{
+    // Per thread, so other threads (and this one outside a region) run unchecked
+    thread_local RealtimeRegion* currentRegion = nullptr;
+    thread_local bool isReporting = false; ///< set while recording, so the report's own allocations pass.
+}
+
+//==============================================================================
+RealtimeRegion::~RealtimeRegion()
+{
+    if (active)
+        leave();
+}
+
+void RealtimeRegion::enter() noexcept
+{
+    previous = currentRegion;
+    currentRegion = this;
+    active = true;
+}
+
+void RealtimeRegion::leave() noexcept
+{
+    if (! active)
+        return;
+
+    currentRegion = previous;
+    previous = nullptr;
+    active = false;
+}
+
+void RealtimeRegion::reportViolation (const char* what) noexcept
+{
+    auto* region = currentRegion;
+
+    if (region == nullptr || isReporting)
+        return;
+
+    isReporting = true;
+
+    if (region->numViolations++ == 0)
+    {
+        region->firstViolation = what;
+        region->firstStackTrace = juce::SystemStats::getStackBacktrace().toStdString();
+    }
+
+    isReporting = false;
+}
+
+std::string RealtimeRegion::getReport() const
+{
+    if (numViolations == 0)
+        return {};
+
+    return "Not realtime safe: " + firstViolation + " in a realtime region ("
+           + std::to_string (numViolations) + " violation" + (numViolations == 1 ? "" : "s")
+           + " in total). First one at:\n" + firstStackTrace;
+}
+
+void RealtimeRegion::clear()
+{
+    numViolations = 0;
+    firstViolation.clear();
+    firstStackTrace.clear();
+}
+
+bool RealtimeRegion::isEnabled() noexcept
+{
+    return ! BYTEMARK_REALTIME_CHECKER_SANITIZED;
+}
+
+bool RealtimeRegion::checksSystemCalls() noexcept
+{
+    return BYTEMARK_REALTIME_CHECKER_GLIBC;
+}
+
+//==============================================================================
+// The underlying allocator, without going through the hooks again
+#if BYTEMARK_REALTIME_CHECKER_GLIBC
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void* __libc_memalign (size_t, size_t);
+    void __libc_free (void*);
+}
+#endif
+
+#if ! BYTEMARK_REALTIME_CHECKER_SANITIZED
+namespace
+{
+    void* rawAllocate (std::size_t size) noexcept
+    {
+       #if BYTEMARK_REALTIME_CHECKER_GLIBC
+        return __libc_malloc (size);
+       #else
+        return std::malloc (size);
+       #endif
+    }
+
+    void rawFree (void* pointer) noexcept
+    {
+       #if BYTEMARK_REALTIME_CHECKER_GLIBC
+        __libc_free (pointer);
+       #else
+        std::free (pointer);
+       #endif
+    }
+
+    void* rawAllocateAligned (std::size_t size, std::size_t alignment) noexcept
+    {
+       #if BYTEMARK_REALTIME_CHECKER_GLIBC
+        return __libc_memalign (alignment, size);
+       #elif defined(_MSC_VER)
+        return _aligned_malloc (size, alignment);
+       #else
+        void* pointer = nullptr;
+        return posix_memalign (&pointer, juce::jmax (alignment, sizeof (void*)), size) == 0 ? pointer : nullptr;
+       #endif
+    }
+
+    void rawFreeAligned (void* pointer) noexcept
+    {
+       #if defined(_MSC_VER)
+        _aligned_free (pointer);
+       #else
+        rawFree (pointer);
+       #endif
+    }
+
+    void* checkedNew (std::size_t size, const char* what) noexcept
+    {
+        RealtimeRegion::reportViolation (what);
+        return rawAllocate (size > 0 ? size : 1);
+    }
+
+    void* checkedNewAligned (std::size_t size, std::align_val_t alignment, const char* what) noexcept
+    {
+        RealtimeRegion::reportViolation (what);
+        return rawAllocateAligned (size > 0 ? size : 1, (std::size_t) alignment);
+    }
+
+    void checkedDelete (void* pointer, const char* what) noexcept
+    {
+        if (pointer == nullptr)
+            return;
+
+        RealtimeRegion::reportViolation (what);
+        rawFree (pointer);
+    }
+
+    void checkedDeleteAligned (void* pointer, const char* what) noexcept
+    {
+        if (pointer == nullptr)
+            return;
+
+        RealtimeRegion::reportViolation (what);
+        rawFreeAligned (pointer);
+    }
+
+    void* throwIfNull (void* pointer)
+    {
+        if (pointer == nullptr)
+            throw std::bad_alloc();
+
+        return pointer;
+    }
+}
+
+//==============================================================================
+// Replacement global allocation functions (all of them, so every new/delete pair matches)
+void* operator new (std::size_t size) { return throwIfNull (checkedNew (size, "operator new")); }
+void* operator new[] (std::size_t size) { return throwIfNull (checkedNew (size, "operator new[]")); }
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept { return checkedNew (size, "operator new"); }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept { return checkedNew (size, "operator new[]"); }
+
+void* operator new (std::size_t size, std::align_val_t alignment) { return throwIfNull (checkedNewAligned (size, alignment, "operator new")); }
+void* operator new[] (std::size_t size, std::align_val_t alignment) { return throwIfNull (checkedNewAligned (size, alignment, "operator new[]")); }
+void* operator new (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return checkedNewAligned (size, alignment, "operator new"); }
+void* operator new[] (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return checkedNewAligned (size, alignment, "operator new[]"); }
+
+void operator delete (void* pointer) noexcept { checkedDelete (pointer, "operator delete"); }
+void operator delete[] (void* pointer) noexcept { checkedDelete (pointer, "operator delete[]"); }
+void operator delete (void* pointer, std::size_t) noexcept { checkedDelete (pointer, "operator delete"); }
+void operator delete[] (void* pointer, std::size_t) noexcept { checkedDelete (pointer, "operator delete[]"); }
+void operator delete (void* pointer, const std::nothrow_t&) noexcept { checkedDelete (pointer, "operator delete"); }
+void operator delete[] (void* pointer, const std::nothrow_t&) noexcept { checkedDelete (pointer, "operator delete[]"); }
+
+void operator delete (void* pointer, std::align_val_t) noexcept { checkedDeleteAligned (pointer, "operator delete"); }
+void operator delete[] (void* pointer, std::align_val_t) noexcept { checkedDeleteAligned (pointer, "operator delete[]"); }
+void operator delete (void* pointer, std::size_t, std::align_val_t) noexcept { checkedDeleteAligned (pointer, "operator delete"); }
+void operator delete[] (void* pointer, std::size_t, std::align_val_t) noexcept { checkedDeleteAligned (pointer, "operator delete[]"); }
+void operator delete (void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { checkedDeleteAligned (pointer, "operator delete"); }
+void operator delete[] (void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { checkedDeleteAligned (pointer, "operator delete[]"); }
+#endif
+
+//==============================================================================
+#if BYTEMARK_REALTIME_CHECKER_GLIBC
+namespace
+{
+    /** The next definition of a libc/libpthread function after ours, looked up once. */
+    template <typename Function>
+    Function findNext (std::atomic<void*>& cached, const char* name) noexcept
+    {
+        auto* function = cached.load (std::memory_order_relaxed);
+
+        if (function == nullptr)
+        {
+            function = dlsym (RTLD_NEXT, name);
+            cached.store (function, std::memory_order_relaxed);
+        }
+
+        return reinterpret_cast<Function> (function);
+    }
+
+    std::atomic<void*> nextMutexLock { nullptr }, nextReadLock { nullptr }, nextWriteLock { nullptr }, nextNanosleep { nullptr };
+}
+
+extern "C"
+{
+    // The C allocator (JUCE's HeapBlock, and anything in C libraries)
+    void* malloc (size_t size) noexcept
+    {
+        RealtimeRegion::reportViolation ("malloc");
+        return __libc_malloc (size);
+    }
+
+    void* calloc (size_t count, size_t size) noexcept
+    {
+        RealtimeRegion::reportViolation ("calloc");
+        return __libc_calloc (count, size);
+    }
+
+    void* realloc (void* pointer, size_t size) noexcept
+    {
+        RealtimeRegion::reportViolation ("realloc");
+        return __libc_realloc (pointer, size);
+    }
+
+    void free (void* pointer) noexcept
+    {
+        if (pointer != nullptr)
+            RealtimeRegion::reportViolation ("free");
+
+        __libc_free (pointer);
+    }
+
+    void* memalign (size_t alignment, size_t size) noexcept
+    {
+        RealtimeRegion::reportViolation ("memalign");
+        return __libc_memalign (alignment, size);
+    }
+
+    void* aligned_alloc (size_t alignment, size_t size) noexcept
+    {
+        RealtimeRegion::reportViolation ("aligned_alloc");
+        return __libc_memalign (alignment, size);
+    }
+
+    int posix_memalign (void** result, size_t alignment, size_t size) noexcept
+    {
+        RealtimeRegion::reportViolation ("posix_memalign");
+
+        if (alignment < sizeof (void*) || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+
+        *result = __libc_memalign (alignment, size);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+
+    // Blocking calls: juce::CriticalSection, std::mutex, std::condition_variable and
+    // WaitableEvent (through their mutex), juce::ReadWriteLock's internals and
+    // std::this_thread::sleep_for
+    int pthread_mutex_lock (pthread_mutex_t* mutex) noexcept
+    {
+        RealtimeRegion::reportViolation ("pthread_mutex_lock");
+        return findNext<int (*) (pthread_mutex_t*)> (nextMutexLock, "pthread_mutex_lock") (mutex);
+    }
+
+    int pthread_rwlock_rdlock (pthread_rwlock_t* lock) noexcept
+    {
+        RealtimeRegion::reportViolation ("pthread_rwlock_rdlock");
+        return findNext<int (*) (pthread_rwlock_t*)> (nextReadLock, "pthread_rwlock_rdlock") (lock);
+    }
+
+    int pthread_rwlock_wrlock (pthread_rwlock_t* lock) noexcept
+    {
+        RealtimeRegion::reportViolation ("pthread_rwlock_wrlock");
+        return findNext<int (*) (pthread_rwlock_t*)> (nextWriteLock, "pthread_rwlock_wrlock") (lock);
+    }
+
+    int nanosleep (const struct timespec* requested, struct timespec* remaining)
+    {
+        RealtimeRegion::reportViolation ("nanosleep");
+        return findNext<int (*) (const struct timespec*, struct timespec*)> (nextNanosleep, "nanosleep") (requested, remaining);
+    }
+}
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+
+/**
+    Catches code that isn't realtime safe while it runs.
+
+    While a RealtimeRegion is active on a thread, the test binary's replacement
+    operator new/delete report every allocation and deallocation made by that
+    thread. On Linux (glibc) malloc, calloc, realloc, free and the aligned
+    variants are interposed too, along with pthread mutex and rwlock locks and
+    nanosleep. So juce::CriticalSection, std::mutex and std::this_thread::sleep_for
+    count, and so do WaitableEvent and std::condition_variable, through the mutex
+    they lock before waiting. The waits themselves (pthread_cond_wait and
+    friends) and sleeps that don't go through nanosleep (juce::Thread::sleep's
+    usleep) aren't hooked. Other threads, and this thread outside a region, are
+    never affected.
+
+    The first violation in a region is recorded with a stack trace; the rest are
+    counted. Nothing is reported from inside the hooks, so check the region once
+    it has finished:
+
+        RealtimeRegion region;
+        region.run ([&] { plugin.processBlock (buffer, midi); });
+
+        INFO (region.getReport());
+        REQUIRE (region.getNumViolations() == 0);
+
+    Sanitizer builds bring their own allocator hooks, so there the checker stays
+    out of the way and isEnabled() returns false.
+*/
+class RealtimeRegion
+{
+public:
+    RealtimeRegion() = default;
+    ~RealtimeRegion();
+
+    /** Runs fn with the checks active on the calling thread. Regions may nest. */
+    template <typename Function>
+    void run (Function&& fn)
+    {
+        struct ScopedLeave
+        {
+            RealtimeRegion& region;
+            ~ScopedLeave() { region.leave(); }
+        };
+
+        enter();
+        const ScopedLeave scope { *this };
+        fn();
+    }
+
+    /** Violations seen in every run() so far. */
+    int getNumViolations() const noexcept { return numViolations; }
+
+    /** The first violation and its stack trace, with the total count (empty if none). */
+    std::string getReport() const;
+
+    /** Forgets everything recorded so far. */
+    void clear();
+
+    /** False when this build can't interpose anything (sanitizers). */
+    static bool isEnabled() noexcept;
+
+    /** True when malloc and the blocking calls are checked as well as operator new. */
+    static bool checksSystemCalls() noexcept;
+
+    //==========================================================================
+    /** Called by the hooks; public only for them. */
+    static void reportViolation (const char* what) noexcept;
+
+private:
+    void enter() noexcept;
+    void leave() noexcept;
+
+    RealtimeRegion* previous = nullptr;
+    bool active = false;
+
+    int numViolations = 0;
+    std::string firstViolation, firstStackTrace;
+
+    RealtimeRegion (const RealtimeRegion&) = delete;
+    RealtimeRegion& operator= (const RealtimeRegion&) = delete;
+};